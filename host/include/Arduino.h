@@ -0,0 +1,86 @@
+// Arduino.h — host stand-in for the arduino-esp32 core.
+//
+// Pulls in the same FreeRTOS/esp headers the real core does so firmware
+// sources compile unchanged.  Hardware calls (GPIO, UART) are no-ops or
+// map onto stdio.
+#pragma once
+#include <algorithm>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "IPAddress.h"
+#include "WString.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+#ifndef LED_BUILTIN
+#define LED_BUILTIN 15
+#endif
+#define SERIAL_8N1 0x800001c
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+inline bool isPrintable(int c) { return c >= 0x20 && c < 0x7F; }
+uint32_t getCpuFrequencyMhz();
+
+class HardwareSerial {
+public:
+  explicit HardwareSerial(int port) : port_(port) {}
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rx = -1, int8_t tx = -1);
+  int available();
+  int read();
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buf, size_t n);
+  size_t print(const char* s);
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t println(const char* s = "");
+  size_t println(const String& s) { return println(s.c_str()); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  void flush();
+  operator bool() const { return true; }
+
+private:
+  int port_;
+};
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+class EspClass {
+public:
+  void restart();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getCycleCount();
+};
+extern EspClass ESP;
+
+void setup();
+void loop();
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+typedef enum { OTA_AUTH_ERROR, OTA_BEGIN_ERROR, OTA_CONNECT_ERROR, OTA_RECEIVE_ERROR, OTA_END_ERROR } ota_error_t;
+
+// OTA stand-in: callbacks are accepted and never fire.
+class ArduinoOTAClass {
+public:
+  typedef void (*THandler)();
+  typedef void (*TProgress)(unsigned int, unsigned int);
+  typedef void (*TError)(ota_error_t);
+  ArduinoOTAClass& onStart(THandler) { return *this; }
+  ArduinoOTAClass& onEnd(THandler) { return *this; }
+  ArduinoOTAClass& onProgress(TProgress) { return *this; }
+  ArduinoOTAClass& onError(TError) { return *this; }
+  ArduinoOTAClass& setHostname(const char*) { return *this; }
+  void begin() {}
+  void handle() {}
+};
+extern ArduinoOTAClass ArduinoOTA;
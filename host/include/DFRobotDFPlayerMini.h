@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include "Arduino.h"
+
+#define DFPLAYER_DEVICE_SD 2
+enum { TimeOut, WrongStack, DFPlayerCardInserted, DFPlayerCardRemoved, DFPlayerCardOnline,
+       DFPlayerPlayFinished, DFPlayerError, DFPlayerUSBInserted, DFPlayerUSBRemoved };
+enum { Busy = 1, Sleeping, SerialWrongStack, CheckSumNotMatch, FileIndexOut, FileMismatch, Advertise };
+
+// DFPlayer stand-in: accepts every command and records what the UART would
+// have carried so host runs can count device traffic.
+class DFRobotDFPlayerMini {
+public:
+  bool begin(HardwareSerial&, bool = true, bool = true) { return true; }
+  void outputDevice(uint8_t) { commands_++; }
+  void volume(uint8_t v) { volume_ = v; commands_++; }
+  void playFolder(uint8_t folder, uint8_t file) { folder_ = folder; file_ = file; commands_++; }
+  void stop() { file_ = 0; commands_++; }
+  bool available() { return false; }
+  uint8_t readType() { return 0; }
+  uint16_t read() { return 0; }
+
+  uint32_t commands() const { return commands_; }
+  uint8_t  currentFile() const { return file_; }
+
+private:
+  uint8_t volume_ = 0, folder_ = 0, file_ = 0;
+  uint32_t commands_ = 0;
+};
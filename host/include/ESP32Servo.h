@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+class Servo {
+public:
+  void setPeriodHertz(int) {}
+  int  attach(int pin, int = 544, int = 2400) { pin_ = pin; return 0; }
+  void writeMicroseconds(int us) { us_ = us; }
+  void write(int deg) { us_ = 544 + deg * 10; }
+  int  readMicroseconds() const { return us_; }
+
+private:
+  int pin_ = -1;
+  int us_ = 1500;
+};
@@ -0,0 +1,90 @@
+// FastLED.h — host stand-in with the pixel types and math helpers the
+// effects use.  show() only counts frames.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+struct CRGB {
+  union {
+    struct { uint8_t r, g, b; };
+    uint8_t raw[3];
+  };
+
+  typedef enum : uint32_t {
+    Black = 0x000000, White = 0xFFFFFF, Red = 0xFF0000, Green = 0x008000,
+    Blue = 0x0000FF, Orange = 0xFFA500, Purple = 0x800080, Yellow = 0xFFFF00,
+  } HTMLColorCode;
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+  CRGB(HTMLColorCode code) : CRGB((uint32_t)code) {}
+
+  CRGB& operator+=(const CRGB& o) {
+    r = (r + o.r > 255) ? 255 : r + o.r;
+    g = (g + o.g > 255) ? 255 : g + o.g;
+    b = (b + o.b > 255) ? 255 : b + o.b;
+    return *this;
+  }
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+};
+
+enum EOrder { RGB = 0012, RBG = 0021, GRB = 0102, GBR = 0120, BRG = 0201, BGR = 0210 };
+enum LEDColorCorrection : uint32_t { TypicalLEDStrip = 0xFFB0F0, UncorrectedColor = 0xFFFFFF };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812B {};
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2815 {};
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2811 {};
+
+class CFastLED {
+public:
+  template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CFastLED& addLeds(CRGB* leds, int n) { leds_ = leds; n_ = n; return *this; }
+  void setBrightness(uint8_t b) { brightness_ = b; }
+  uint8_t getBrightness() const { return brightness_; }
+  void setCorrection(LEDColorCorrection) {}
+  void clear(bool writeData = false) {
+    if (leds_) memset((void*)leds_, 0, sizeof(CRGB) * n_);
+    if (writeData) show();
+  }
+  void show() { frames_++; }
+  uint32_t frames() const { return frames_; }
+
+private:
+  CRGB* leds_ = nullptr;
+  int n_ = 0;
+  uint8_t brightness_ = 255;
+  volatile uint32_t frames_ = 0;
+};
+extern CFastLED FastLED;
+
+uint8_t  random8();
+uint8_t  random8(uint8_t lim);
+uint8_t  random8(uint8_t min, uint8_t lim);
+uint16_t random16();
+uint16_t random16(uint16_t lim);
+uint16_t random16(uint16_t min, uint16_t lim);
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) { unsigned t = i + j; return t > 255 ? 255 : t; }
+inline uint8_t qsub8(uint8_t i, uint8_t j) { int t = i - j; return t < 0 ? 0 : t; }
+inline uint8_t scale8(uint8_t i, uint8_t scale) { return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8); }
+
+inline void fill_solid(CRGB* leds, int n, const CRGB& c) { for (int i = 0; i < n; ++i) leds[i] = c; }
+inline void fadeToBlackBy(CRGB* leds, uint16_t n, uint8_t fadeBy) {
+  const uint8_t keep = 255 - fadeBy;
+  for (uint16_t i = 0; i < n; ++i) {
+    leds[i].r = scale8(leds[i].r, keep);
+    leds[i].g = scale8(leds[i].g, keep);
+    leds[i].b = scale8(leds[i].b, keep);
+  }
+}
+
+// Fire2012 palette: black -> red -> yellow -> white.
+inline CRGB HeatColor(uint8_t temperature) {
+  const uint8_t t192 = scale8(temperature, 191);
+  uint8_t heatramp = (t192 & 0x3F) << 2;
+  if (t192 & 0x80) return CRGB(255, 255, heatramp);
+  if (t192 & 0x40) return CRGB(255, heatramp, 0);
+  return CRGB(heatramp, 0, 0);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include "WString.h"
+
+class IPAddress {
+public:
+  IPAddress() : addr_(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : addr_((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+  // Network byte order, as stored in sin_addr.s_addr.
+  explicit IPAddress(uint32_t raw) : addr_(raw) {}
+
+  operator uint32_t() const { return addr_; }
+  uint8_t operator[](int i) const { return (uint8_t)(addr_ >> (8 * i)); }
+  bool operator==(const IPAddress& o) const { return addr_ == o.addr_; }
+  bool operator!=(const IPAddress& o) const { return addr_ != o.addr_; }
+
+  bool fromString(const char* s);
+  String toString() const;
+
+private:
+  uint32_t addr_;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+#include "WString.h"
+
+// File-backed NVS stand-in.  Each key is a file under $HOST_NVS_DIR
+// (default ".host_nvs") named "<node>_<namespace>_<key>.bin", where
+// <node> comes from $HOST_NODE_ID so simulated nodes keep separate stores.
+class Preferences {
+public:
+  bool   begin(const char* ns, bool readOnly = false);
+  void   end() {}
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t len);
+  size_t putBytes(const char* key, const void* buf, size_t len);
+  bool   remove(const char* key);
+
+private:
+  std::string path_(const char* key) const;
+  std::string ns_;
+};
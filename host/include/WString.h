@@ -0,0 +1,45 @@
+#pragma once
+#include <stddef.h>
+#include <stdlib.h>
+#include <string>
+
+// Minimal Arduino String built on std::string.
+class String {
+public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v) : s_(std::to_string(v)) {}
+  explicit String(unsigned v) : s_(std::to_string(v)) {}
+  explicit String(long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+
+  const char* c_str() const { return s_.c_str(); }
+  size_t length() const { return s_.size(); }
+  char operator[](size_t i) const { return i < s_.size() ? s_[i] : '\0'; }
+  char charAt(size_t i) const { return (*this)[i]; }
+
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(const char* c) { s_ += c; return *this; }
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String operator+(const String& o) const { return String(s_ + o.s_); }
+  String operator+(const char* o) const { return String(s_ + o); }
+
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return s_ != o.s_; }
+
+  void remove(size_t idx) { if (idx < s_.size()) s_.erase(idx); }
+  void remove(size_t idx, size_t n) { if (idx < s_.size()) s_.erase(idx, n); }
+  void trim() {
+    const char* ws = " \t\r\n";
+    size_t b = s_.find_first_not_of(ws);
+    if (b == std::string::npos) { s_.clear(); return; }
+    s_ = s_.substr(b, s_.find_last_not_of(ws) - b + 1);
+  }
+  int toInt() const { return atoi(s_.c_str()); }
+
+private:
+  std::string s_;
+};
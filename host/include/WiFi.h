@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WString.h"
+
+// Host stand-in: the "station" uses the loopback interface ($HOST_IP
+// overrides the reported address) and sees one access point.  A join
+// aimed at another BSSID never completes, so the cached-BSSID fallback can
+// be exercised by changing $HOST_AP_BSSID between runs.
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+} arduino_event_id_t;
+
+typedef struct { uint8_t reason; } wifi_event_sta_disconnected_t;
+typedef union { wifi_event_sta_disconnected_t wifi_sta_disconnected; } arduino_event_info_t;
+typedef struct {
+  arduino_event_id_t event_id;
+  arduino_event_info_t event_info;
+} arduino_event_t;
+
+typedef void (*WiFiEventSysCb)(arduino_event_t* event);
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t) { return true; }
+  bool setSleep(bool) { return true; }
+  void persistent(bool) {}
+  bool disconnect(bool = false, bool = false) { return true; }
+  bool reconnect();
+  bool config(IPAddress local, IPAddress gw, IPAddress mask, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  wl_status_t begin(const char* ssid, const char* pass = nullptr, int32_t channel = 0,
+                    const uint8_t* bssid = nullptr, bool connect = true);
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  int onEvent(WiFiEventSysCb) { return 0; }
+
+  int16_t scanNetworks(bool async = false, bool hidden = false);
+  String SSID(uint8_t i) const;
+  const uint8_t* BSSID(uint8_t i);
+  int32_t channel(uint8_t i) { return 6; }
+  int32_t RSSI(uint8_t i) { return -45; }
+
+  String SSID() const;
+  String BSSIDstr() const { return String("02:00:00:00:00:01"); }
+  const uint8_t* BSSID();
+  String macAddress() const;
+  int8_t RSSI() const { return -45; }
+  int32_t channel() const { return 6; }
+  IPAddress localIP() const;
+  IPAddress gatewayIP() const { return IPAddress(127, 0, 0, 1); }
+  IPAddress subnetMask() const { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(uint8_t = 0) const { return IPAddress(127, 0, 0, 1); }
+
+private:
+  String ssid_;
+};
+extern WiFiClass WiFi;
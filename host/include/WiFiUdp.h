@@ -0,0 +1,34 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "IPAddress.h"
+
+// UDP over real host sockets.  Multicast is joined and looped back on the
+// interface given by $HOST_MCAST_IF (default 127.0.0.1) so several node
+// processes on one machine share a show group.
+class WiFiUDP {
+public:
+  ~WiFiUDP() { stop(); }
+  uint8_t beginMulticast(IPAddress group, uint16_t port);
+  void    stop();
+  int     parsePacket();
+  int     read(uint8_t* buf, size_t len);
+  IPAddress remoteIP() const { return remote_; }
+  uint16_t  remotePort() const { return remotePort_; }
+
+  int    beginPacket(IPAddress ip, uint16_t port);
+  size_t write(const uint8_t* buf, size_t len);
+  int    endPacket();
+
+private:
+  int rxFd_ = -1;
+  int txFd_ = -1;
+  IPAddress remote_;
+  uint16_t remotePort_ = 0;
+  std::vector<uint8_t> rx_;
+  size_t rxPos_ = 0;
+  IPAddress txIp_;
+  uint16_t txPort_ = 0;
+  std::vector<uint8_t> tx_;
+};
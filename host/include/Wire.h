@@ -0,0 +1,17 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// I2C stand-in: no device ever answers.
+class TwoWire {
+public:
+  bool begin(int, int, uint32_t) { return false; }
+  void beginTransmission(uint8_t) {}
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t*, size_t n) { return n; }
+  uint8_t endTransmission(bool = true) { return 2; }
+  size_t requestFrom(uint8_t, size_t) { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+};
+extern TwoWire Wire;
@@ -0,0 +1,17 @@
+#pragma once
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef bool (*esp_freertos_idle_cb_t)();
+
+// Hooks run on a SCHED_IDLE thread that sleeps one tick per pass, the way the
+// idle task waits for the next interrupt.
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, UBaseType_t cpu);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*vprintf_like_t)(const char*, va_list);
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+void esp_log_write_host(char level, const char* tag, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL 0
+#endif
+
+#define ESP_LOGE(tag, fmt, ...) do { if (CORE_DEBUG_LEVEL >= 1) esp_log_write_host('E', tag, fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGW(tag, fmt, ...) do { if (CORE_DEBUG_LEVEL >= 2) esp_log_write_host('W', tag, fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, fmt, ...) do { if (CORE_DEBUG_LEVEL >= 3) esp_log_write_host('I', tag, fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, fmt, ...) do { if (CORE_DEBUG_LEVEL >= 4) esp_log_write_host('D', tag, fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { if (CORE_DEBUG_LEVEL >= 5) esp_log_write_host('V', tag, fmt, ##__VA_ARGS__); } while (0)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef struct {
+  int  max_freq_mhz;
+  int  min_freq_mhz;
+  bool light_sleep_enable;
+} esp_pm_config_t;
+
+// No power management on the host.
+inline esp_err_t esp_pm_get_configuration(void*) { return ESP_ERR_NOT_SUPPORTED; }
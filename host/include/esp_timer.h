@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Microseconds since process start (monotonic), like the IDF high-resolution timer.
+int64_t esp_timer_get_time();
+
+#ifdef __cplusplus
+}
+#endif
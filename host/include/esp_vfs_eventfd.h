@@ -0,0 +1,13 @@
+#pragma once
+#include <stddef.h>
+#include <sys/eventfd.h>
+#include "esp_err.h"
+
+// Host stand-in: Linux eventfds need no VFS registration.
+typedef struct {
+  size_t max_fds;
+} esp_vfs_eventfd_config_t;
+
+#define ESP_VFS_EVENTD_CONFIG_DEFAULT() (esp_vfs_eventfd_config_t{5})
+
+inline esp_err_t esp_vfs_eventfd_register(const esp_vfs_eventfd_config_t*) { return ESP_OK; }
@@ -0,0 +1,70 @@
+// FreeRTOS.h — host stand-in for the subset of the FreeRTOS API used by the firmware.
+//
+// Tasks are pthreads, queues and semaphores are mutex/condvar rings, and the
+// tick is 1 ms of CLOCK_MONOTONIC.  Semantics follow the ESP-IDF port where it
+// matters (stack depth in bytes, pinned-to-core creation, ISR variants).
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t      TickType_t;
+typedef uint8_t       StackType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+#define errQUEUE_FULL ((BaseType_t)0)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_PRIORITIES    25
+#define configMINIMAL_STACK_SIZE 768
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define pdTICKS_TO_MS(t)        ((TickType_t)(((TickType_t)(t) * (TickType_t)1000U) / (TickType_t)configTICK_RATE_HZ))
+#define tskNO_AFFINITY          ((BaseType_t)0x7FFFFFFF)
+#define portNUM_PROCESSORS      1
+
+// Run time stats in microseconds.  The idle counter is wall time not spent
+// on any firmware thread, as if they all shared one core.
+#define configGENERATE_RUN_TIME_STATS 1
+uint32_t host_run_time_counter();
+#define portGET_RUN_TIME_COUNTER_VALUE() host_run_time_counter()
+
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+
+typedef struct HostTask*  TaskHandle_t;
+typedef struct HostQueue* QueueHandle_t;
+typedef struct HostQueue* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Static allocation placeholders (storage is ignored on the host).
+typedef struct { uint8_t opaque[64]; } StaticTask_t;
+typedef struct { uint8_t opaque[64]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+// Critical sections: one global recursive lock.
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void host_enter_critical();
+void host_exit_critical();
+#define portENTER_CRITICAL(m)      do { (void)(m); host_enter_critical(); } while (0)
+#define portEXIT_CRITICAL(m)       do { (void)(m); host_exit_critical(); } while (0)
+#define taskENTER_CRITICAL(m)      portENTER_CRITICAL(m)
+#define taskEXIT_CRITICAL(m)       portEXIT_CRITICAL(m)
+#define portENTER_CRITICAL_ISR(m)  portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL_ISR(m)   portEXIT_CRITICAL(m)
+
+BaseType_t xPortGetCoreID();
+
+#ifdef __cplusplus
+}
+#endif
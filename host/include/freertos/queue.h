@@ -0,0 +1,27 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t* storage, StaticQueue_t* qbuf);
+void          vQueueDelete(QueueHandle_t q);
+BaseType_t    xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t    xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t    xQueueOverwrite(QueueHandle_t q, const void* item);
+BaseType_t    xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks);
+BaseType_t    xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t q);
+UBaseType_t   uxQueueSpacesAvailable(QueueHandle_t q);
+inline UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t q) { return uxQueueMessagesWaiting(q); }
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* hpw) {
+  if (hpw) *hpw = pdFALSE;
+  return xQueueSend(q, item, 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { eNoAction = 0, eSetBits, eIncrement, eSetValueWithOverwrite, eSetValueWithoutOverwrite } eNotifyAction;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t prio, TaskHandle_t* out, BaseType_t core);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                           void* arg, UBaseType_t prio, StackType_t* stack,
+                                           StaticTask_t* tcb, BaseType_t core);
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                              void* arg, UBaseType_t prio, TaskHandle_t* out) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, prio, out, tskNO_AFFINITY);
+}
+
+void        vTaskDelay(TickType_t ticks);
+void        vTaskDelayUntil(TickType_t* prevWake, TickType_t increment);
+BaseType_t  xTaskDelayUntil(TickType_t* prevWake, TickType_t increment);
+TickType_t  xTaskGetTickCount();
+TickType_t  xTaskGetTickCountFromISR();
+void        vTaskDelete(TaskHandle_t t);
+void        vTaskSuspend(TaskHandle_t t);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t t);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t t);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t t);
+UBaseType_t uxTaskGetNumberOfTasks();
+void        taskYIELD();
+uint32_t    ulTaskGetIdleRunTimeCounter();
+
+BaseType_t xTaskGenericNotify(TaskHandle_t t, uint32_t value, eNotifyAction action);
+inline BaseType_t xTaskNotify(TaskHandle_t t, uint32_t value, eNotifyAction action) {
+  return xTaskGenericNotify(t, value, action);
+}
+inline BaseType_t xTaskNotifyGive(TaskHandle_t t) { return xTaskGenericNotify(t, 0, eIncrement); }
+inline BaseType_t xTaskNotifyFromISR(TaskHandle_t t, uint32_t value, eNotifyAction action, BaseType_t* hpw) {
+  if (hpw) *hpw = pdFALSE;
+  return xTaskGenericNotify(t, value, action);
+}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t* hpw) {
+  if (hpw) *hpw = pdFALSE;
+  xTaskGenericNotify(t, 0, eIncrement);
+}
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* valueOut, TickType_t ticks);
+uint32_t   ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# run_nodes.sh — start several host nodes that share one loopback show group.
+#
+# Usage:
+#   pio run -e native
+#   host/run_nodes.sh [count] [program]
+#
+# Node n (1..count) keeps its settings in $RUN_DIR/nvs, logs to
+# $RUN_DIR/<n>.log and reads console commands from the FIFO $RUN_DIR/<n>.in:
+#   echo "queues" > .host_nodes/2.in
+# Ctrl-C stops every node.
+#
+# With SKEW_PPM set, node clocks run at rates spread evenly over
+# +-SKEW_PPM and start n seconds apart, for testing the fleet clock.
+
+COUNT=${1:-3}
+PROGRAM=${2:-.pio/build/native/program}
+RUN_DIR=${RUN_DIR:-.host_nodes}
+
+if [ ! -x "$PROGRAM" ]; then
+  echo "No host build at $PROGRAM (run: pio run -e native)" >&2
+  exit 1
+fi
+
+mkdir -p "$RUN_DIR/nvs"
+pids=()
+trap 'kill "${pids[@]}" 2>/dev/null; exit 0' INT TERM
+
+for n in $(seq 1 "$COUNT"); do
+  fifo="$RUN_DIR/$n.in"
+  [ -p "$fifo" ] || mkfifo "$fifo"
+  # Hold the FIFO open so the node never sees end of input.
+  exec {fd}<>"$fifo"
+  clock=()
+  if [ -n "$SKEW_PPM" ]; then
+    span=$(( COUNT > 1 ? COUNT - 1 : 1 ))
+    clock=(HOST_CLOCK_PPM=$(( SKEW_PPM * (2 * n - COUNT - 1) / span )) HOST_CLOCK_OFFSET_MS=$(( n * 1000 )))
+  fi
+  env "${clock[@]}" HOST_NVS_DIR="$RUN_DIR/nvs" HOST_NODE_ID=$n "$PROGRAM" <&$fd >"$RUN_DIR/$n.log" 2>&1 &
+  pids+=($!)
+  # Give every node its own device id (persisted on first run).
+  (sleep 2; printf "cfg set id %s\ncfg save\n" "$n" >"$fifo") &
+done
+
+echo "Started ${#pids[@]} nodes, logs in $RUN_DIR/"
+wait
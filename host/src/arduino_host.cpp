@@ -0,0 +1,357 @@
+// arduino_host.cpp — host implementations of the Arduino/ESP-IDF stand-ins.
+#include <arpa/inet.h>
+#include <chrono>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "ArduinoOTA.h"
+#include "esp_log.h"
+#include "FastLED.h"
+#include "Preferences.h"
+#include "WiFi.h"
+#include "WiFiUdp.h"
+#include "Wire.h"
+
+static double env_num(const char* name) {
+  const char* v = getenv(name);
+  return (v && *v) ? atof(v) : 0.0;
+}
+
+// ---------- Time ----------
+// $HOST_CLOCK_PPM and $HOST_CLOCK_OFFSET_MS give a node its own crystal
+// error and boot time, so fleet clock sync has something to correct.  When
+// either is set the start point on the shared monotonic clock is logged, so
+// host/sync_check.sh can work out the true time behind any local reading.
+struct HostClock {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double rate = 1.0 + env_num("HOST_CLOCK_PPM") * 1e-6;
+  int64_t offsetUs = (int64_t)(env_num("HOST_CLOCK_OFFSET_MS") * 1000);
+  HostClock() {
+    if (rate != 1.0 || offsetUs) {
+      fprintf(stderr, "host clock: start %lld us, rate %.9f, offset %lld us\n",
+              (long long)std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count(),
+              rate, (long long)offsetUs);
+    }
+  }
+};
+static const HostClock g_clock;
+
+int64_t esp_timer_get_time() {
+  const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_clock.start).count();
+  return (int64_t)(us * g_clock.rate) + g_clock.offsetUs;
+}
+unsigned long millis() { return (unsigned long)(esp_timer_get_time() / 1000); }
+unsigned long micros() { return (unsigned long)esp_timer_get_time(); }
+void delay(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+void delayMicroseconds(uint32_t us) { usleep(us); }
+uint32_t getCpuFrequencyMhz() { return 160; }
+
+// ---------- GPIO ----------
+static uint8_t g_pins[64];
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t val) { g_pins[pin & 63] = val; }
+int  digitalRead(uint8_t pin) { return g_pins[pin & 63]; }
+
+// ---------- Random ----------
+static std::mutex g_rngMtx;
+static std::mt19937 g_rng(12345);
+static uint32_t rng_next() {
+  std::lock_guard<std::mutex> lk(g_rngMtx);
+  return g_rng();
+}
+long random(long howbig) { return howbig > 0 ? (long)(rng_next() % (uint32_t)howbig) : 0; }
+long random(long lo, long hi) { return hi > lo ? lo + random(hi - lo) : lo; }
+void randomSeed(unsigned long seed) { std::lock_guard<std::mutex> lk(g_rngMtx); g_rng.seed(seed); }
+uint8_t  random8() { return (uint8_t)rng_next(); }
+uint8_t  random8(uint8_t lim) { return (uint8_t)(((uint32_t)random8() * lim) >> 8); }
+uint8_t  random8(uint8_t lo, uint8_t lim) { return lo + random8(lim - lo); }
+uint16_t random16() { return (uint16_t)rng_next(); }
+uint16_t random16(uint16_t lim) { return (uint16_t)(((uint32_t)random16() * lim) >> 16); }
+uint16_t random16(uint16_t lo, uint16_t lim) { return lo + random16(lim - lo); }
+
+// ---------- Serial ----------
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+
+void HardwareSerial::begin(unsigned long, uint32_t, int8_t, int8_t) {
+  if (port_ == 0) fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+}
+
+static std::string g_stdinBuf;
+int HardwareSerial::available() {
+  if (port_ != 0) return 0;
+  char tmp[128];
+  ssize_t n = ::read(STDIN_FILENO, tmp, sizeof(tmp));
+  if (n > 0) g_stdinBuf.append(tmp, (size_t)n);
+  return (int)g_stdinBuf.size();
+}
+int HardwareSerial::read() {
+  if (port_ != 0 || g_stdinBuf.empty()) return -1;
+  char c = g_stdinBuf[0];
+  g_stdinBuf.erase(0, 1);
+  return (uint8_t)c;
+}
+size_t HardwareSerial::write(uint8_t c) { return port_ == 0 ? fwrite(&c, 1, 1, stdout) : 1; }
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+  if (port_ != 0) return n;
+  size_t w = fwrite(buf, 1, n, stdout);
+  fflush(stdout);
+  return w;
+}
+size_t HardwareSerial::print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+size_t HardwareSerial::println(const char* s) { size_t n = print(s); return n + print("\n"); }
+size_t HardwareSerial::printf(const char* fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  return n > 0 ? write((const uint8_t*)buf, std::min((size_t)n, sizeof(buf) - 1)) : 0;
+}
+void HardwareSerial::flush() { fflush(stdout); }
+
+// ---------- ESP ----------
+EspClass ESP;
+void EspClass::restart() { fflush(stdout); _exit(3); }
+uint32_t EspClass::getFreeHeap() { return 300 * 1024; }
+uint32_t EspClass::getMinFreeHeap() { return 280 * 1024; }
+uint32_t EspClass::getCycleCount() {
+  // Nanosecond clock scaled to a 160 MHz core so device and host numbers line up.
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  return (uint32_t)((uint64_t)ns * 160 / 1000);
+}
+
+// ---------- esp_log ----------
+static vprintf_like_t g_logVprintf = vprintf;
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+  vprintf_like_t old = g_logVprintf;
+  g_logVprintf = func;
+  return old;
+}
+static int log_call(const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = g_logVprintf(fmt, ap);
+  va_end(ap);
+  return n;
+}
+void esp_log_write_host(char level, const char* tag, const char* fmt, ...) {
+  char msg[384];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, ap);
+  va_end(ap);
+  log_call("%c (%lu) %s: %s\n", level, millis(), tag, msg);
+}
+
+// ---------- IPAddress ----------
+bool IPAddress::fromString(const char* s) {
+  in_addr a;
+  if (inet_pton(AF_INET, s, &a) != 1) return false;
+  addr_ = a.s_addr;
+  return true;
+}
+String IPAddress::toString() const {
+  char buf[20];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(buf);
+}
+
+// ---------- Preferences ----------
+static std::string env_or(const char* name, const char* dflt) {
+  const char* v = getenv(name);
+  return (v && *v) ? v : dflt;
+}
+
+bool Preferences::begin(const char* ns, bool) {
+  ns_ = ns;
+  mkdir(env_or("HOST_NVS_DIR", ".host_nvs").c_str(), 0755);
+  return true;
+}
+std::string Preferences::path_(const char* key) const {
+  return env_or("HOST_NVS_DIR", ".host_nvs") + "/" + env_or("HOST_NODE_ID", "0") + "_" + ns_ + "_" + key + ".bin";
+}
+size_t Preferences::getBytesLength(const char* key) {
+  struct stat st;
+  return stat(path_(key).c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+size_t Preferences::getBytes(const char* key, void* buf, size_t len) {
+  FILE* f = fopen(path_(key).c_str(), "rb");
+  if (!f) return 0;
+  size_t n = fread(buf, 1, len, f);
+  fclose(f);
+  return n;
+}
+size_t Preferences::putBytes(const char* key, const void* buf, size_t len) {
+  FILE* f = fopen(path_(key).c_str(), "wb");
+  if (!f) return 0;
+  size_t n = fwrite(buf, 1, len, f);
+  fclose(f);
+  return n;
+}
+bool Preferences::remove(const char* key) { return ::remove(path_(key).c_str()) == 0; }
+
+// ---------- WiFi ----------
+// The one access point: $HOST_AP_SSID (default the settings default),
+// $HOST_AP_BSSID (last byte of its BSSID, default 1), and $HOST_SCAN_MS,
+// how long a blocking scan takes (a real 11 channel scan is ~2 s).
+WiFiClass WiFi;
+static uint8_t g_bssid[6] = {0x02, 0, 0, 0, 0, 0x01};
+static bool g_associated = true;
+
+static const uint8_t* ap_bssid() {
+  g_bssid[5] = (uint8_t)atoi(env_or("HOST_AP_BSSID", "1").c_str());
+  return g_bssid;
+}
+
+bool WiFiClass::config(IPAddress, IPAddress, IPAddress, IPAddress, IPAddress) { return true; }
+wl_status_t WiFiClass::begin(const char* ssid, const char*, int32_t, const uint8_t* bssid, bool) {
+  ssid_ = ssid;
+  g_associated = !bssid || memcmp(bssid, ap_bssid(), sizeof(g_bssid)) == 0;
+  return status();
+}
+bool WiFiClass::reconnect() {
+  g_associated = true;
+  return true;
+}
+wl_status_t WiFiClass::status() { return g_associated ? WL_CONNECTED : WL_DISCONNECTED; }
+int16_t WiFiClass::scanNetworks(bool, bool) {
+  const double ms = env_num("HOST_SCAN_MS");
+  if (ms > 0) usleep((useconds_t)(ms * 1000));
+  return 1;
+}
+String WiFiClass::SSID(uint8_t) const { return String(env_or("HOST_AP_SSID", "showiot")); }
+const uint8_t* WiFiClass::BSSID(uint8_t) { return ap_bssid(); }
+const uint8_t* WiFiClass::BSSID() { return ap_bssid(); }
+String WiFiClass::SSID() const { return ssid_; }
+String WiFiClass::macAddress() const {
+  return String(std::string("02:00:00:00:00:") + env_or("HOST_NODE_ID", "0"));
+}
+IPAddress WiFiClass::localIP() const {
+  IPAddress ip(127, 0, 0, 1);
+  ip.fromString(env_or("HOST_IP", "127.0.0.1").c_str());
+  return ip;
+}
+
+// ---------- WiFiUDP ----------
+static in_addr mcast_if() {
+  in_addr a;
+  inet_pton(AF_INET, env_or("HOST_MCAST_IF", "127.0.0.1").c_str(), &a);
+  return a;
+}
+
+uint8_t WiFiUDP::beginMulticast(IPAddress group, uint16_t port) {
+  stop();
+  rxFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (rxFd_ < 0) return 0;
+  int one = 1;
+  setsockopt(rxFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  setsockopt(rxFd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(rxFd_, (sockaddr*)&addr, sizeof(addr)) < 0) { stop(); return 0; }
+  ip_mreq mreq{};
+  mreq.imr_multiaddr.s_addr = (uint32_t)group;
+  mreq.imr_interface = mcast_if();
+  if (setsockopt(rxFd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) { stop(); return 0; }
+  fcntl(rxFd_, F_SETFL, fcntl(rxFd_, F_GETFL) | O_NONBLOCK);
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (rxFd_ >= 0) close(rxFd_);
+  rxFd_ = -1;
+}
+
+int WiFiUDP::parsePacket() {
+  if (rxFd_ < 0) return 0;
+  rx_.resize(1500);
+  sockaddr_in from{};
+  socklen_t fl = sizeof(from);
+  ssize_t n = recvfrom(rxFd_, rx_.data(), rx_.size(), 0, (sockaddr*)&from, &fl);
+  if (n <= 0) { rx_.clear(); return 0; }
+  rx_.resize((size_t)n);
+  rxPos_ = 0;
+  remote_ = IPAddress((uint32_t)from.sin_addr.s_addr);
+  remotePort_ = ntohs(from.sin_port);
+  return (int)n;
+}
+
+int WiFiUDP::read(uint8_t* buf, size_t len) {
+  size_t n = std::min(len, rx_.size() - rxPos_);
+  memcpy(buf, rx_.data() + rxPos_, n);
+  rxPos_ += n;
+  return (int)n;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  if (txFd_ < 0) {
+    txFd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (txFd_ < 0) return 0;
+    in_addr ifa = mcast_if();
+    unsigned char loop = 1, ttl = 1;
+    setsockopt(txFd_, IPPROTO_IP, IP_MULTICAST_IF, &ifa, sizeof(ifa));
+    setsockopt(txFd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    setsockopt(txFd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+  }
+  txIp_ = ip;
+  txPort_ = port;
+  tx_.clear();
+  return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* buf, size_t len) {
+  tx_.insert(tx_.end(), buf, buf + len);
+  return len;
+}
+
+// $HOST_NET_DELAY_US and $HOST_NET_JITTER_US hold each datagram back by
+// the delay plus a uniform random share of the jitter, to stand in for the
+// air.  Jittered datagrams may overtake each other, as on WiFi.
+static void delayed_send(int fd, std::vector<uint8_t> data, sockaddr_in to, int64_t delayUs) {
+  std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+  sendto(fd, data.data(), data.size(), 0, (sockaddr*)&to, sizeof(to));
+}
+
+int WiFiUDP::endPacket() {
+  static const int64_t delayUs = (int64_t)env_num("HOST_NET_DELAY_US");
+  static const int64_t jitterUs = (int64_t)env_num("HOST_NET_JITTER_US");
+  static std::mutex jitterMtx;
+  static std::minstd_rand jitterRng(std::random_device{}());
+
+  sockaddr_in to{};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(txPort_);
+  to.sin_addr.s_addr = (uint32_t)txIp_;
+  if (delayUs <= 0 && jitterUs <= 0) {
+    return sendto(txFd_, tx_.data(), tx_.size(), 0, (sockaddr*)&to, sizeof(to)) == (ssize_t)tx_.size();
+  }
+  int64_t d = delayUs;
+  if (jitterUs > 0) {
+    std::lock_guard<std::mutex> lk(jitterMtx);
+    d += (int64_t)(jitterRng() % (uint64_t)(jitterUs + 1));
+  }
+  std::thread(delayed_send, txFd_, tx_, to, d).detach();
+  return 1;
+}
+
+// ---------- Peripherals ----------
+CFastLED FastLED;
+ArduinoOTAClass ArduinoOTA;
+TwoWire Wire;
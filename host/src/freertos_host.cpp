@@ -0,0 +1,358 @@
+// freertos_host.cpp — pthread-backed implementation of the FreeRTOS stand-in.
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "esp_freertos_hooks.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point g_epoch = Clock::now();
+
+Clock::time_point tick_to_time(TickType_t t) {
+  return g_epoch + std::chrono::milliseconds(t);
+}
+
+// Absolute deadline for a relative tick timeout (portMAX_DELAY = forever).
+bool deadline_for(TickType_t ticks, Clock::time_point& out) {
+  if (ticks == portMAX_DELAY) return false;
+  out = Clock::now() + std::chrono::milliseconds(ticks);
+  return true;
+}
+
+std::recursive_mutex g_critical;
+
+}  // namespace
+
+struct HostTask {
+  std::string name;
+  UBaseType_t prio = 0;
+  uint32_t stackDepth = 0;
+  TaskFunction_t fn = nullptr;
+  void* arg = nullptr;
+
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t value = 0;
+  bool pending = false;
+};
+
+struct HostQueue {
+  std::mutex m;
+  std::condition_variable cv;
+  size_t length = 0;
+  size_t itemSize = 0;
+  std::deque<std::vector<uint8_t>> items;
+  size_t count = 0;  // used for item-less semaphores
+};
+
+namespace {
+
+std::mutex g_tasksMtx;
+std::vector<HostTask*> g_tasks;
+thread_local HostTask* t_self = nullptr;
+
+HostTask* self_task() {
+  if (!t_self) {
+    // Threads not created through xTaskCreate (e.g. main) get a lazy TCB.
+    HostTask* t = new HostTask();
+    t->name = "main";
+    t->prio = 1;
+    std::lock_guard<std::mutex> lk(g_tasksMtx);
+    g_tasks.push_back(t);
+    t_self = t;
+  }
+  return t_self;
+}
+
+void* task_trampoline(void* pv) {
+  HostTask* t = static_cast<HostTask*>(pv);
+  t_self = t;
+  pthread_setname_np(pthread_self(), t->name.substr(0, 15).c_str());
+  t->fn(t->arg);
+  return nullptr;
+}
+
+}  // namespace
+
+void host_enter_critical() { g_critical.lock(); }
+void host_exit_critical() { g_critical.unlock(); }
+BaseType_t xPortGetCoreID() { return 0; }
+
+// ---------- Tasks ----------
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t prio, TaskHandle_t* out, BaseType_t) {
+  HostTask* t = new HostTask();
+  t->name = name ? name : "task";
+  t->prio = prio;
+  t->stackDepth = stackDepth;
+  t->fn = fn;
+  t->arg = arg;
+  {
+    std::lock_guard<std::mutex> lk(g_tasksMtx);
+    g_tasks.push_back(t);
+  }
+  pthread_t th;
+  if (pthread_create(&th, nullptr, task_trampoline, t) != 0) return pdFAIL;
+  pthread_detach(th);
+  if (out) *out = t;
+  return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                           void* arg, UBaseType_t prio, StackType_t*, StaticTask_t*,
+                                           BaseType_t core) {
+  TaskHandle_t h = nullptr;
+  if (xTaskCreatePinnedToCore(fn, name, stackDepth, arg, prio, &h, core) != pdPASS) return nullptr;
+  return h;
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - g_epoch).count();
+}
+TickType_t xTaskGetTickCountFromISR() { return xTaskGetTickCount(); }
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks ? ticks : 0));
+  if (!ticks) std::this_thread::yield();
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* prevWake, TickType_t increment) {
+  const TickType_t next = *prevWake + increment;
+  *prevWake = next;
+  if ((int32_t)(next - xTaskGetTickCount()) <= 0) return pdFALSE;
+  std::this_thread::sleep_until(tick_to_time(next));
+  return pdTRUE;
+}
+void vTaskDelayUntil(TickType_t* prevWake, TickType_t increment) { (void)xTaskDelayUntil(prevWake, increment); }
+
+void vTaskDelete(TaskHandle_t t) {
+  if (t == nullptr || t == t_self) pthread_exit(nullptr);
+}
+
+void vTaskSuspend(TaskHandle_t t) {
+  if (t == nullptr || t == t_self) {
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(24));
+  }
+}
+
+void taskYIELD() { std::this_thread::yield(); }
+
+// ---------- Run time stats / idle ----------
+static uint64_t process_cpu_us() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+uint32_t host_run_time_counter() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_epoch).count();
+}
+
+uint32_t ulTaskGetIdleRunTimeCounter() {
+  const uint64_t wall = host_run_time_counter();
+  const uint64_t busy = process_cpu_us();
+  return busy < wall ? (uint32_t)(wall - busy) : 0;
+}
+
+namespace {
+std::mutex g_idleMtx;
+std::vector<esp_freertos_idle_cb_t> g_idleHooks;
+
+void* idle_thread(void*) {
+  pthread_setname_np(pthread_self(), "IDLE");
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lk(g_idleMtx);
+      for (auto cb : g_idleHooks) cb();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return nullptr;
+}
+}  // namespace
+
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, UBaseType_t) {
+  std::lock_guard<std::mutex> lk(g_idleMtx);
+  if (g_idleHooks.empty()) {
+    pthread_t th;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_IDLE);
+    sched_param sp{};
+    pthread_attr_setschedparam(&attr, &sp);
+    const int rc = pthread_create(&th, &attr, idle_thread, nullptr);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) return ESP_FAIL;
+    pthread_detach(th);
+  }
+  g_idleHooks.push_back(cb);
+  return ESP_OK;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return self_task(); }
+const char* pcTaskGetName(TaskHandle_t t) { return (t ? t : self_task())->name.c_str(); }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t t) {
+  // No stack painting on the host; report half the requested depth.
+  return (t ? t : self_task())->stackDepth / 2;
+}
+UBaseType_t uxTaskPriorityGet(TaskHandle_t t) { return (t ? t : self_task())->prio; }
+UBaseType_t uxTaskGetNumberOfTasks() {
+  std::lock_guard<std::mutex> lk(g_tasksMtx);
+  return g_tasks.size();
+}
+
+// ---------- Notifications ----------
+BaseType_t xTaskGenericNotify(TaskHandle_t t, uint32_t value, eNotifyAction action) {
+  if (!t) return pdFAIL;
+  std::lock_guard<std::mutex> lk(t->m);
+  BaseType_t rc = pdPASS;
+  switch (action) {
+    case eNoAction: break;
+    case eSetBits: t->value |= value; break;
+    case eIncrement: t->value++; break;
+    case eSetValueWithOverwrite: t->value = value; break;
+    case eSetValueWithoutOverwrite:
+      if (t->pending) rc = pdFAIL; else t->value = value;
+      break;
+  }
+  t->pending = true;
+  t->cv.notify_all();
+  return rc;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* valueOut, TickType_t ticks) {
+  HostTask* t = self_task();
+  std::unique_lock<std::mutex> lk(t->m);
+  if (!t->pending) t->value &= ~clearOnEntry;
+  Clock::time_point dl;
+  if (deadline_for(ticks, dl)) {
+    t->cv.wait_until(lk, dl, [&] { return t->pending; });
+  } else {
+    t->cv.wait(lk, [&] { return t->pending; });
+  }
+  if (valueOut) *valueOut = t->value;
+  if (!t->pending) return pdFALSE;
+  t->pending = false;
+  t->value &= ~clearOnExit;
+  return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  HostTask* t = self_task();
+  std::unique_lock<std::mutex> lk(t->m);
+  Clock::time_point dl;
+  auto ready = [&] { return t->value != 0; };
+  if (deadline_for(ticks, dl)) {
+    t->cv.wait_until(lk, dl, ready);
+  } else {
+    t->cv.wait(lk, ready);
+  }
+  const uint32_t v = t->value;
+  if (v) t->value = clearOnExit ? 0 : v - 1;
+  t->pending = false;
+  return v;
+}
+
+// ---------- Queues ----------
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue* q = new HostQueue();
+  q->length = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize, uint8_t*, StaticQueue_t*) {
+  return xQueueCreate(length, itemSize);
+}
+
+void vQueueDelete(QueueHandle_t q) { delete q; }
+
+static size_t q_count(HostQueue* q) { return q->itemSize ? q->items.size() : q->count; }
+
+static BaseType_t q_send(HostQueue* q, const void* item, TickType_t ticks, bool overwrite) {
+  if (!q) return pdFAIL;
+  std::unique_lock<std::mutex> lk(q->m);
+  auto space = [&] { return q_count(q) < q->length; };
+  if (!space() && !overwrite) {
+    if (ticks == 0) return errQUEUE_FULL;
+    Clock::time_point dl;
+    if (deadline_for(ticks, dl)) {
+      if (!q->cv.wait_until(lk, dl, space)) return errQUEUE_FULL;
+    } else {
+      q->cv.wait(lk, space);
+    }
+  }
+  if (q->itemSize) {
+    if (overwrite && !space()) q->items.pop_back();
+    const uint8_t* p = static_cast<const uint8_t*>(item);
+    q->items.emplace_back(p, p + q->itemSize);
+  } else if (space()) {
+    q->count++;
+  }
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+static BaseType_t q_recv(HostQueue* q, void* item, TickType_t ticks, bool peek) {
+  if (!q) return pdFAIL;
+  std::unique_lock<std::mutex> lk(q->m);
+  auto avail = [&] { return q_count(q) > 0; };
+  if (!avail()) {
+    if (ticks == 0) return pdFAIL;
+    Clock::time_point dl;
+    if (deadline_for(ticks, dl)) {
+      if (!q->cv.wait_until(lk, dl, avail)) return pdFAIL;
+    } else {
+      q->cv.wait(lk, avail);
+    }
+  }
+  if (q->itemSize) {
+    if (item) memcpy(item, q->items.front().data(), q->itemSize);
+    if (!peek) q->items.pop_front();
+  } else if (!peek) {
+    q->count--;
+  }
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) { return q_send(q, item, ticks, false); }
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks) { return q_send(q, item, ticks, false); }
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item) { return q_send(q, item, 0, true); }
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) { return q_recv(q, item, ticks, false); }
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks) { return q_recv(q, item, ticks, true); }
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lk(q->m);
+  return q_count(q);
+}
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lk(q->m);
+  return q->length - q_count(q);
+}
+
+// ---------- Semaphores ----------
+SemaphoreHandle_t xSemaphoreCreateBinary() { return xQueueCreate(1, 0); }
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SemaphoreHandle_t s = xQueueCreate(1, 0);
+  s->count = 1;
+  return s;
+}
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t*) { return xSemaphoreCreateMutex(); }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) { return q_recv(s, nullptr, ticks, false); }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { return q_send(s, nullptr, 0, false); }
@@ -0,0 +1,14 @@
+// main_host.cpp — process entry for the native build.
+//
+// Runs the firmware's setup() and then loop() on the main thread, the way
+// the arduino-esp32 loopTask does.
+#include <Arduino.h>
+
+int main()
+{
+  setup();
+  for (;;)
+  {
+    loop();
+  }
+}
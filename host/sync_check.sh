@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# sync_check.sh — measure fleet clock error across host nodes.
+#
+# Usage:
+#   pio run -e native
+#   host/sync_check.sh [count] [seconds] [program]
+#
+# Starts count nodes with run_nodes.sh, each with its own clock rate and
+# offset (SKEW_PPM), and holds every datagram back by HOST_NET_DELAY_US
+# plus up to HOST_NET_JITTER_US.  Once a second each node reports its local
+# and fleet time ("clock"); each report is mapped back to the shared host
+# clock and compared with node 1, the leader.  Reports in the first WARMUP
+# seconds are skipped.  Fails if any error exceeds LIMIT_US.
+
+COUNT=${1:-3}
+RUN_SECONDS=${2:-60}
+PROGRAM=${3:-.pio/build/native/program}
+export RUN_DIR=${RUN_DIR:-.host_sync}
+export SKEW_PPM=${SKEW_PPM:-40}
+export HOST_NET_DELAY_US=${HOST_NET_DELAY_US:-2000}
+export HOST_NET_JITTER_US=${HOST_NET_JITTER_US:-3000}
+WARMUP=${WARMUP:-15}
+LIMIT_US=${LIMIT_US:-2000}
+
+rm -f "$RUN_DIR"/*.log
+"$(dirname "$0")/run_nodes.sh" "$COUNT" "$PROGRAM" >/dev/null &
+runner=$!
+trap 'kill $runner 2>/dev/null' EXIT
+
+sleep 3
+for _ in $(seq 1 "$RUN_SECONDS"); do
+  for n in $(seq 1 "$COUNT"); do echo "clock" >"$RUN_DIR/$n.in"; done
+  sleep 1
+done
+kill $runner 2>/dev/null
+wait $runner 2>/dev/null
+
+echo "Delay ${HOST_NET_DELAY_US} us + jitter ${HOST_NET_JITTER_US} us, clocks +-${SKEW_PPM} ppm"
+for n in $(seq 1 "$COUNT"); do echo "$RUN_DIR/$n.log"; done | xargs awk -v warmup="$WARMUP" -v limit="$LIMIT_US" '
+  FNR == 1 { node++ }
+  /^host clock:/ { start[node] = $4; rate[node] = $7; off[node] = $9 }
+  /Now: local/ { n = ++samples[node]; local[node, n] = $3; fleet[node, n] = $6 }
+  END {
+    worst = 0
+    for (i = 2; i <= node; i++) {
+      used = 0; sum = 0; max = 0
+      for (k = 1; k <= samples[i]; k++) {
+        # True time of this report on the shared clock, and node 1 clock then.
+        t = start[i] + (local[i, k] - off[i]) / rate[i]
+        if (t - start[1] < warmup * 1000000) continue
+        err = fleet[i, k] - ((t - start[1]) * rate[1] + off[1])
+        if (err < 0) err = -err
+        used++; sum += err; if (err > max) max = err
+      }
+      if (!used) { printf("node %d: no reports\n", i); worst = limit + 1; continue }
+      printf("node %d: %d reports, error avg %.0f us, max %.0f us\n", i, used, sum / used, max)
+      if (max > worst) worst = max
+    }
+    printf("%s: worst %.0f us (limit %d us)\n", worst <= limit ? "PASS" : "FAIL", worst, limit)
+    exit(worst <= limit ? 0 : 1)
+  }'
@@ -0,0 +1,418 @@
+// loadgen.cpp — flood the show group with a mix of frames and find the
+// packet rate a node keeps up with.
+//
+// Build from the repo root:
+//   g++ -std=gnu++17 -O2 -DHOST_BUILD -Iinclude -Ihost/include host/tools/loadgen.cpp -o loadgen
+//
+// Usage:
+//   loadgen [--in PATH --out PATH] [options]
+//
+// Each step sends frames at one rate for --secs seconds, as a fixed mix of
+// pings, triggers and malformed frames.  The pings are the short form an
+// older node sends; the malformed frames rotate through a bad magic, a cut
+// header, a batch record running off the end and an oversize datagram.
+//
+// With --in and --out pointing at a node's console (a host node's FIFO and
+// log from run_nodes.sh, or one serial device for both on hardware), the
+// node's "net stats" counters are reset before and read after every step.
+// The table then shows what the node received and handled against what was
+// sent, and the report ends with the highest rate the node kept up with:
+// datagram and trigger loss both within --limit percent.  Without them only
+// the send side is reported; read "net stats" on the node by hand.
+//
+// Options:
+//   --group ADDR   Show group (239.255.0.1)
+//   --port N       Show port (49400)
+//   --if ADDR      Interface to send on (127.0.0.1)
+//   --dst ID       Node the triggers are addressed to (255 = all nodes)
+//   --src ID       Node id to send as (200; above the peer table on purpose)
+//   --rates LIST   Frames/s of each step (500,1000,2000,5000,10000,20000,50000)
+//   --secs N       Seconds per step (3)
+//   --mix P,T,M    Percent of pings, triggers and malformed frames (70,20,10)
+//   --limit PCT    Loss that ends the keep-up range (1.0)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "Protocol.h"
+
+// ---- Options ----
+struct Options {
+  const char* group = "239.255.0.1";
+  uint16_t port = 49400;
+  const char* iface = "127.0.0.1";
+  uint8_t dst = Proto::BROADCAST;
+  uint8_t src = 200;
+  std::vector<uint32_t> rates = {500, 1000, 2000, 5000, 10000, 20000, 50000};
+  uint32_t secs = 3;
+  uint32_t mix[3] = {70, 20, 10};
+  double limitPct = 1.0;
+  const char* in = nullptr;
+  const char* out = nullptr;
+};
+
+enum Kind { KIND_PING = 0, KIND_TRIGGER, KIND_MALFORMED, KIND_COUNT };
+
+// What the node reported for one step (see "net stats").
+struct NodeStats {
+  unsigned long datagrams = 0, malformed = 0, duplicates = 0, noBuffer = 0, fromSelf = 0;
+  unsigned long handled = 0, notForMe = 0, unknown = 0;
+  unsigned long ping = 0, mode = 0, trigger = 0, timeReq = 0, timeResp = 0;
+};
+
+static uint64_t now_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t t) {
+  timespec ts;
+  ts.tv_sec = (time_t)(t / 1000000000ull);
+  ts.tv_nsec = (long)(t % 1000000000ull);
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+}
+
+// ---- Frames ----
+class FrameSource {
+public:
+  explicit FrameSource(const Options& o) : opt_(o) {}
+
+  // Build the next frame of kind k into out.  Returns its length.
+  size_t build(Kind k, uint8_t* out, size_t cap) {
+    size_t len = 0;
+    switch (k) {
+      case KIND_PING: {
+        Proto::PingMsg ping;
+        ping.rssi = -50;
+        ping.rangeMm = 123;
+        // Cut to the fields an older sender has, so no fleet time is fed.
+        if (Proto::encode(out, cap, Proto::BROADCAST, opt_.src, ping))
+          len = Proto::HDR_SIZE + Proto::Schema<Proto::PingMsg>::MIN_PAYLOAD;
+        break;
+      }
+      case KIND_TRIGGER: {
+        Proto::TriggerAnimMsg trig;
+        trig.animId = 1;
+        len = Proto::encode(out, cap, opt_.dst, opt_.src, trig);
+        break;
+      }
+      default:
+        return malformed_(out, cap);
+    }
+    Proto::stampHeader(out, seq_++, 0);
+    return len;
+  }
+
+private:
+  size_t malformed_(uint8_t* out, size_t cap) {
+    Proto::PingMsg ping;
+    size_t len = Proto::encode(out, cap, Proto::BROADCAST, opt_.src, ping);
+    Proto::stampHeader(out, seq_++, 0);
+    switch (bad_++ % 4) {
+      case 0:
+        out[0] = 0x5A;                 // Bad magic
+        break;
+      case 1:
+        len = Proto::HDR_SIZE - 1;     // Header cut short
+        break;
+      case 2:
+        out[3] = Proto::CMD_BATCH;     // Batch whose record runs off the end
+        out[Proto::HDR_SIZE] = Proto::CMD_PING;
+        out[Proto::HDR_SIZE + 1] = Proto::BROADCAST;
+        out[Proto::HDR_SIZE + 2] = 200;
+        break;
+      default:
+        len = Proto::MAX_FRAME + 1;    // Oversize
+        if (len > cap) len = cap;
+        break;
+    }
+    return len;
+  }
+
+  const Options& opt_;
+  uint16_t seq_ = 0;
+  uint32_t bad_ = 0;
+};
+
+// ---- Node console ----
+// Commands go to the node's console input; replies are read from what the
+// node wrote to its output after the command was sent.
+class NodeConsole {
+public:
+  bool open(const char* in, const char* out) {
+    inFd_ = ::open(in, O_WRONLY | O_NONBLOCK | O_NOCTTY);
+    outFd_ = ::open(out, O_RDONLY | O_NONBLOCK | O_NOCTTY);
+    if (inFd_ < 0 || outFd_ < 0) return false;
+    raw_(inFd_);
+    raw_(outFd_);
+    return true;
+  }
+
+  bool enabled() const { return inFd_ >= 0 && outFd_ >= 0; }
+
+  // Send cmd and collect output until a line containing until appears.
+  // Returns the output, or an empty string on timeout.
+  std::string command(const char* cmd, const char* until, uint32_t timeoutMs = 3000) {
+    lseek(outFd_, 0, SEEK_END);   // A log: skip what is already there
+    drain_();
+    std::string line = std::string(cmd) + "\n";
+    if (write(inFd_, line.data(), line.size()) != (ssize_t)line.size()) return std::string();
+
+    std::string got;
+    const uint64_t end = now_ns() + (uint64_t)timeoutMs * 1000000ull;
+    char buf[4096];
+    while (now_ns() < end) {
+      const ssize_t n = read(outFd_, buf, sizeof(buf));
+      if (n > 0) {
+        got.append(buf, (size_t)n);
+        const size_t at = got.find(until);
+        if (at != std::string::npos && got.find('\n', at) != std::string::npos) return got;
+      } else {
+        usleep(20000);
+      }
+    }
+    return std::string();
+  }
+
+  // The node's id from "cfg show", or -1.
+  int deviceId() {
+    const std::string r = command("cfg show", "device id:");
+    const char* d = strstr(r.c_str(), "device id:");
+    unsigned id;
+    return (d && sscanf(d, "device id: %u", &id) == 1) ? (int)id : -1;
+  }
+
+  bool stats(NodeStats& s) {
+    const std::string r = command("net stats", "Handled:");
+    const char* d = strstr(r.c_str(), "Datagrams:");
+    const char* c = strstr(r.c_str(), "Commands:");
+    const char* h = strstr(r.c_str(), "Handled:");
+    return d && c && h &&
+           sscanf(d, "Datagrams: %lu received, %lu malformed, %lu duplicates, %lu no buffer, %lu from self",
+                  &s.datagrams, &s.malformed, &s.duplicates, &s.noBuffer, &s.fromSelf) == 5 &&
+           sscanf(c, "Commands: %lu handled, %lu not for me, %lu unknown",
+                  &s.handled, &s.notForMe, &s.unknown) == 3 &&
+           sscanf(h, "Handled: ping %lu, mode %lu, trigger %lu, time req %lu, time resp %lu",
+                  &s.ping, &s.mode, &s.trigger, &s.timeReq, &s.timeResp) == 5;
+  }
+
+private:
+  static void raw_(int fd) {
+    termios t;
+    if (!isatty(fd) || tcgetattr(fd, &t) != 0) return;
+    cfmakeraw(&t);
+    cfsetspeed(&t, B115200);
+    tcsetattr(fd, TCSANOW, &t);
+  }
+
+  // Serial devices have no end to seek to; drop what is buffered instead.
+  void drain_() {
+    if (!isatty(outFd_)) return;
+    char buf[512];
+    while (read(outFd_, buf, sizeof(buf)) > 0) {
+    }
+  }
+
+  int inFd_ = -1;
+  int outFd_ = -1;
+};
+
+// ---- Options parsing ----
+static bool parse_list(const char* s, std::vector<uint32_t>& out) {
+  out.clear();
+  while (*s) {
+    char* end;
+    const unsigned long v = strtoul(s, &end, 10);
+    if (end == s || v == 0) return false;
+    out.push_back((uint32_t)v);
+    s = (*end == ',') ? end + 1 : end;
+    if (*end && *end != ',') return false;
+  }
+  return !out.empty();
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: loadgen [--in PATH --out PATH] [--group ADDR] [--port N] [--if ADDR]\n"
+          "               [--dst ID] [--src ID] [--rates LIST] [--secs N] [--mix P,T,M]\n"
+          "               [--limit PCT]\n");
+}
+
+static bool parse_options(int argc, char** argv, Options& o) {
+  static const option longOpts[] = {
+    {"group", required_argument, nullptr, 'g'}, {"port", required_argument, nullptr, 'p'},
+    {"if", required_argument, nullptr, 'i'},    {"dst", required_argument, nullptr, 'd'},
+    {"src", required_argument, nullptr, 's'},   {"rates", required_argument, nullptr, 'r'},
+    {"secs", required_argument, nullptr, 't'},  {"mix", required_argument, nullptr, 'm'},
+    {"limit", required_argument, nullptr, 'l'}, {"in", required_argument, nullptr, 'I'},
+    {"out", required_argument, nullptr, 'O'},   {nullptr, 0, nullptr, 0},
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'g': o.group = optarg; break;
+      case 'p': o.port = (uint16_t)atoi(optarg); break;
+      case 'i': o.iface = optarg; break;
+      case 'd': o.dst = (uint8_t)atoi(optarg); break;
+      case 's': o.src = (uint8_t)atoi(optarg); break;
+      case 'r': if (!parse_list(optarg, o.rates)) return false; break;
+      case 't': o.secs = (uint32_t)atoi(optarg); break;
+      case 'l': o.limitPct = atof(optarg); break;
+      case 'I': o.in = optarg; break;
+      case 'O': o.out = optarg; break;
+      case 'm':
+        if (sscanf(optarg, "%u,%u,%u", &o.mix[0], &o.mix[1], &o.mix[2]) != 3 ||
+            o.mix[0] + o.mix[1] + o.mix[2] == 0) {
+          return false;
+        }
+        break;
+      default: return false;
+    }
+  }
+  return o.secs > 0 && (!o.in == !o.out);
+}
+
+static double loss_pct(unsigned long got, unsigned long sent) {
+  if (!sent || got >= sent) return 0.0;
+  return 100.0 * (double)(sent - got) / (double)sent;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parse_options(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  in_addr ifa{};
+  sockaddr_in to{};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(opt.port);
+  if (fd < 0 || inet_pton(AF_INET, opt.iface, &ifa) != 1 ||
+      inet_pton(AF_INET, opt.group, &to.sin_addr) != 1) {
+    fprintf(stderr, "loadgen: bad address or no socket\n");
+    return 1;
+  }
+  unsigned char loop = 1, ttl = 1;
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &ifa, sizeof(ifa));
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+  NodeConsole node;
+  if (opt.in && !node.open(opt.in, opt.out)) {
+    fprintf(stderr, "loadgen: cannot open node console %s / %s\n", opt.in, opt.out);
+    return 1;
+  }
+
+  // Triggers for another node still cross the read path, as not for me.
+  bool triggersForNode = true;
+  if (node.enabled() && opt.dst != Proto::BROADCAST) {
+    const int id = node.deviceId();
+    triggersForNode = id == opt.dst;
+    if (!triggersForNode)
+      printf("Node is %d, so triggers to %u count as delivered when not for me\n", id, opt.dst);
+  }
+
+  const uint32_t mixTotal = opt.mix[0] + opt.mix[1] + opt.mix[2];
+  printf("Mix %u%% ping, %u%% trigger, %u%% malformed; triggers to %u; %u s per step\n",
+         opt.mix[0] * 100 / mixTotal, opt.mix[1] * 100 / mixTotal, opt.mix[2] * 100 / mixTotal,
+         opt.dst, opt.secs);
+  if (node.enabled()) {
+    printf(" target/s  sent/s    sent   recv  malf  nobuf  handled  trig sent  trig ok  dgram loss  trig loss\n");
+  } else {
+    printf(" target/s  sent/s    sent  pings  triggers  malformed\n");
+  }
+
+  FrameSource frames(opt);
+  uint8_t buf[Proto::MAX_FRAME + 1];
+  uint32_t keptUpRate = 0;
+  uint32_t firstLossRate = 0;
+
+  for (uint32_t rate : opt.rates) {
+    if (node.enabled() && node.command("net stats reset", "Receive counters restarted.").empty()) {
+      fprintf(stderr, "loadgen: no reply from the node console\n");
+      return 1;
+    }
+
+    // Pick each frame's kind by largest credit, so the mix holds over any
+    // stretch of the step, not just on average.
+    int32_t credit[KIND_COUNT] = {};
+    unsigned long sent[KIND_COUNT] = {};
+    unsigned long total = 0;
+    const uint64_t period = 1000000000ull / rate;
+    const uint64_t start = now_ns();
+    const uint64_t stop = start + (uint64_t)opt.secs * 1000000000ull;
+    uint64_t due = start;
+    while (due < stop) {
+      if (now_ns() < due) sleep_until_ns(due);
+      Kind k = KIND_PING;
+      for (int i = 0; i < KIND_COUNT; i++) {
+        credit[i] += (int32_t)opt.mix[i];
+        if (credit[i] > credit[k]) k = (Kind)i;
+      }
+      credit[k] -= (int32_t)mixTotal;
+
+      const size_t len = frames.build(k, buf, sizeof(buf));
+      if (sendto(fd, buf, len, 0, (sockaddr*)&to, sizeof(to)) == (ssize_t)len) {
+        sent[k]++;
+        total++;
+      }
+      due += period;
+    }
+    const double secs = (double)(now_ns() - start) / 1e9;
+    const uint32_t achieved = (uint32_t)((double)total / secs);
+
+    if (!node.enabled()) {
+      printf(" %8u  %6u  %6lu  %5lu  %8lu  %9lu\n", rate, achieved, total,
+             sent[KIND_PING], sent[KIND_TRIGGER], sent[KIND_MALFORMED]);
+      continue;
+    }
+
+    usleep(500000);   // Let the node drain
+    NodeStats s;
+    if (!node.stats(s)) {
+      fprintf(stderr, "loadgen: could not read net stats from the node\n");
+      return 1;
+    }
+    // Our datagrams only; the node also hears the rest of the fleet.
+    const unsigned long recv = s.datagrams - s.fromSelf;
+    const double dgramLoss = loss_pct(recv > total ? total : recv, total);
+    const unsigned long trigOk = triggersForNode ? s.trigger : s.notForMe;
+    const double trigLoss = loss_pct(trigOk, sent[KIND_TRIGGER]);
+    printf(" %8u  %6u  %6lu  %5lu  %4lu  %5lu  %7lu  %9lu  %7lu  %9.2f%%  %8.2f%%\n",
+           rate, achieved, total, recv, s.malformed, s.noBuffer, s.handled,
+           sent[KIND_TRIGGER], trigOk, dgramLoss, trigLoss);
+    fflush(stdout);
+
+    if (dgramLoss <= opt.limitPct && trigLoss <= opt.limitPct) {
+      if (!firstLossRate) keptUpRate = achieved;
+    } else if (!firstLossRate) {
+      firstLossRate = achieved;
+    }
+  }
+
+  if (node.enabled()) {
+    if (firstLossRate) {
+      printf("Knee: kept up to %u frames/s; loss over %.1f%% from %u frames/s\n",
+             keptUpRate, opt.limitPct, firstLossRate);
+    } else {
+      printf("Knee: not reached; kept up at every step (last %u frames/s)\n", keptUpRate);
+    }
+  }
+  close(fd);
+  return 0;
+}
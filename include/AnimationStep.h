@@ -4,6 +4,7 @@
 #include "Audio.h"
 #include "Light.h"
 #include "Motor.h"
+#include "StepParams.h"
 
 
 // Struct capturing the discrete steps of a show.
@@ -12,4 +13,5 @@ struct AnimationStep {
     LightAnim lightIndex;    // Light animation for this step.
     AudioAnim audioIndex;    // Audio animation for this step.
     MotorAnim motorIndex;    // Motor animation for this step.
+    StepParams params;       // Effect parameters, zero = animation defaults.
 };
\ No newline at end of file
@@ -23,15 +23,14 @@ static constexpr uint8_t NUM_AUDIO_ANIMATIONS = static_cast<uint8_t>(AudioAnim::
 // Starts the audio task that drives the mp3 player hardware.
 //
 // Returns: true on success, false on failure.
-bool audio_start(UBaseType_t priority = 2,
-                uint32_t stack_bytes = 4096,
-                BaseType_t core = 0);
+bool audio_start();
 
 // Halts any audio playback.
 void stop_audio_player();
 
-// Starts playing audio file in specific numbered folder.
-void play_audio_file(int folder, int file);
+// Starts playing audio file in specific numbered folder.  A non-zero volume
+// overrides the file's default playback volume.
+void play_audio_file(int folder, int file, uint8_t volume = 0);
 
 // Sets playback volume.
 void set_volume(uint8_t volume);
@@ -0,0 +1,74 @@
+// CommandCoalescer.h — header-only latest-wins collapse of a command burst
+//
+// Usage:
+//   CommandCoalescer<LightCmdQueueMsg, 1> pending;
+//   while (RecvLightQueue(msg)) pending.add(0, msg);   // drain everything
+//   while (pending.next(msg)) { ...apply msg... }       // survivors, in order
+//   queue_stats_coalesced(BusQueue::Light, pending.takeEliminated());
+//
+// Notes:
+// - Commands in the same group drive the same output and supersede each
+//   other: a Stop followed by a Play (or Play, Play) leaves only the last.
+// - Commands in different groups (e.g. Volume vs Play) are all kept and
+//   handed back in the order their latest member arrived.
+
+#pragma once
+#include <Arduino.h>
+
+template <typename Msg, size_t GROUPS>
+class CommandCoalescer
+{
+public:
+  static_assert(GROUPS > 0 && GROUPS <= 8, "1..8 groups supported");
+
+  // Hold msg as the pending command for its group.
+  inline void add(size_t group, const Msg& msg)
+  {
+    if (group >= GROUPS)
+    {
+      return;
+    }
+    if (has_[group])
+    {
+      eliminated_++;
+    }
+    slot_[group] = msg;
+    order_[group] = seq_++;
+    has_[group] = true;
+  }
+
+  // Hand back the oldest pending command.  Returns false when none are left.
+  inline bool next(Msg& out)
+  {
+    size_t best = GROUPS;
+    for (size_t g = 0; g < GROUPS; g++)
+    {
+      if (has_[g] && (best == GROUPS || order_[g] < order_[best]))
+      {
+        best = g;
+      }
+    }
+    if (best == GROUPS)
+    {
+      return false;
+    }
+    has_[best] = false;
+    out = slot_[best];
+    return true;
+  }
+
+  // Number of commands dropped since the last call.
+  inline uint32_t takeEliminated()
+  {
+    const uint32_t n = eliminated_;
+    eliminated_ = 0;
+    return n;
+  }
+
+private:
+  Msg      slot_[GROUPS]{};
+  uint32_t order_[GROUPS]{};
+  bool     has_[GROUPS]{};
+  uint32_t seq_ = 0;
+  uint32_t eliminated_ = 0;
+};
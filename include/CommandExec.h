@@ -8,6 +8,8 @@
 // and prints replies with io_printf().
 //
 // Returns: true on success, false on failure.
-bool command_exec_start(UBaseType_t priority = 2,
-                        uint32_t stack_bytes = 4096,
-                        BaseType_t core = 1);
\ No newline at end of file
+bool command_exec_start();
+
+// Cache a WiFi join for a fast rejoin on the next boot.  Safe from any task:
+// the settings are changed and saved on the executor task.
+void command_exec_cache_join(const NetService::JoinInfo& joined);
@@ -2,6 +2,12 @@
 #include <Arduino.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "SpscRing.h"
+#include "StaticAlloc.h"
+#include "StepParams.h"
+#include "TaskProfiler.h"
 
 // ===== Command enums for each queue type =====
 enum class ShowInputQueueCmd  : uint8_t { None=0, Start=1, Stop=2, TriggerLocal=3, TriggerPeer=4 };
@@ -10,30 +16,36 @@ enum class LightQueueCmd : uint8_t { None=0, Play=1, Stop=2 };
 enum class MotorQueueCmd : uint8_t { None=0, Play=1, Stop=2, Home=3 };
 
 // ===== Message payloads for each queue =====
-struct ShowInputQueueMsg  { ShowInputQueueCmd cmd; uint8_t param; }; /* If TriggerPeer, param = peer station # */
-struct NetSendQueueMsg    { uint8_t  dest; uint8_t cmd; uint8_t param; };
-struct AudioCmdQueueMsg   { AudioQueueCmd cmd; uint8_t param; };
-struct LightCmdQueueMsg   { LightQueueCmd cmd; uint8_t param; };
-struct MotorCmdQueueMsg   { MotorQueueCmd cmd; uint8_t param; };
+// stampUs is written by the Send wrappers (enqueue time) for latency stats.
+struct ShowInputQueueMsg  { ShowInputQueueCmd cmd; uint8_t param; uint8_t origin; uint16_t waveStepMs; uint32_t startAt; uint32_t stampUs; }; /* If TriggerPeer, param = animation id, origin = station that triggered, startAt = fleet ms (0 = now), waveStepMs = per-position delay */
+struct NetSendQueueMsg    { uint8_t  dest; uint8_t cmd; uint8_t param; uint8_t copies; uint16_t waveStepMs; uint32_t startAt; uint32_t stampUs; }; /* cmd = Proto command; frame is built by the net task at transmit time; copies > 1 = redundant burst */
+struct AudioCmdQueueMsg   { AudioQueueCmd cmd; uint8_t param; StepParams params; uint32_t stampUs; }; /* params applied on Play */
+struct LightCmdQueueMsg   { LightQueueCmd cmd; uint8_t param; StepParams params; uint32_t stampUs; };
+struct MotorCmdQueueMsg   { MotorQueueCmd cmd; uint8_t param; StepParams params; uint32_t stampUs; };
 
 // (sanity) validate sizes if you rely on tight wire formats
-static_assert(sizeof(ShowInputQueueMsg) == 2, "ShowInputQueueMsg must be 2 bytes");
-static_assert(sizeof(AudioCmdQueueMsg)  == 2, "AudioCmdQueueMsg must be 2 bytes");
-static_assert(sizeof(LightCmdQueueMsg)  == 2, "LightCmdQueueMsg must be 2 bytes");
-static_assert(sizeof(MotorCmdQueueMsg)  == 2, "MotorCmdQueueMsg must be 2 bytes");
-static_assert(sizeof(NetSendQueueMsg)   == 3, "NetSendQueueMsg must be 3 bytes");
+static_assert(sizeof(ShowInputQueueMsg) == 16, "ShowInputQueueMsg must be 16 bytes");
+static_assert(sizeof(AudioCmdQueueMsg)  == 24, "AudioCmdQueueMsg must be 24 bytes");
+static_assert(sizeof(LightCmdQueueMsg)  == 24, "LightCmdQueueMsg must be 24 bytes");
+static_assert(sizeof(MotorCmdQueueMsg)  == 24, "MotorCmdQueueMsg must be 24 bytes");
+static_assert(sizeof(NetSendQueueMsg)   == 16, "NetSendQueueMsg must be 16 bytes");
 
-// ===== Centralized queue bus (global/shared) =====
-struct QueueBus {
-  QueueHandle_t showInputQueueHandle = nullptr;
-  QueueHandle_t netSendQueueHandle   = nullptr;
-  QueueHandle_t audioCmdQueueHandle  = nullptr;
-  QueueHandle_t lightCmdQueueHandle  = nullptr;
-  QueueHandle_t motorCmdQueueHandle  = nullptr;
-};
+// ===== Queue health =====
+// Identifies each bus queue for the health counters.
+enum class BusQueue : uint8_t { ShowInput=0, NetSend=1, Audio=2, Light=3, Motor=4, COUNT };
+static constexpr size_t NUM_BUS_QUEUES = static_cast<size_t>(BusQueue::COUNT);
 
-// Global instance (defined in CommandQueues.cpp)
-extern QueueBus queueBus;
+// Counters kept by the typed Send/Recv wrappers for each queue.
+struct QueueStats {
+  uint32_t enqueued  = 0;  // Successful sends
+  uint32_t dequeued  = 0;  // Successful receives
+  uint32_t failed    = 0;  // Sends dropped, queue full
+  uint32_t coalesced = 0;  // Commands superseded or no-ops, never applied
+  uint32_t highWater = 0;  // Most items ever waiting
+  uint32_t latLastUs = 0;  // Enqueue to dequeue latency of the last receive
+  uint32_t latMaxUs  = 0;  // Worst enqueue to dequeue latency
+  uint64_t latSumUs  = 0;  // Sum over dequeued, for the mean
+};
 
 // ===== Configuration (tune lengths as needed) =====
 #ifndef Q_SHOW_INPUT_LEN
@@ -52,14 +64,133 @@ extern QueueBus queueBus;
 #define Q_MOTOR_CMD_LEN  8
 #endif
 
+// Each bus splits its length between the producer ring (the largest power of
+// two up to half) and the FreeRTOS queue (the rest), so ring plus queue never
+// hold more than the configured depth.
+static constexpr size_t bus_pow2_floor(size_t n) { return n < 2 ? 1 : 2 * bus_pow2_floor(n / 2); }
+static constexpr size_t bus_ring_len(size_t len) { return bus_pow2_floor(len / 2) < 2 ? 2 : bus_pow2_floor(len / 2); }
+static constexpr size_t bus_queue_len(size_t len) { return len - bus_ring_len(len); }
+
+static_assert(Q_SHOW_INPUT_LEN >= 3 && Q_NET_SEND_LEN >= 3 && Q_AUDIO_CMD_LEN >= 3 &&
+              Q_LIGHT_CMD_LEN >= 3 && Q_MOTOR_CMD_LEN >= 3,
+              "Each bus needs at least 2 ring slots and 1 queue slot");
+
+// ===== Centralized queue bus (global/shared) =====
+struct QueueBus {
+  QueueHandle_t showInputQueueHandle = nullptr;
+  QueueHandle_t netSendQueueHandle   = nullptr;
+  QueueHandle_t audioCmdQueueHandle  = nullptr;
+  QueueHandle_t lightCmdQueueHandle  = nullptr;
+  QueueHandle_t motorCmdQueueHandle  = nullptr;
+
+  // Consumer task woken when a command lands on each queue.  Each consumer
+  // sets its own handle when it starts (nullptr = nobody to wake).
+  TaskHandle_t showInputConsumer = nullptr;
+  TaskHandle_t netSendConsumer   = nullptr;
+  TaskHandle_t audioCmdConsumer  = nullptr;
+  TaskHandle_t lightCmdConsumer  = nullptr;
+  TaskHandle_t motorCmdConsumer  = nullptr;
+
+  // Lock-free fast path.  Each queue may have one registered producer task
+  // whose sends go through the ring instead of the FreeRTOS queue; every
+  // other sender (console, network, ISRs) keeps using the queue.  The
+  // producer sets its own handle when it starts.
+  SpscRing<ShowInputQueueMsg, bus_ring_len(Q_SHOW_INPUT_LEN)> showInputRing;
+  SpscRing<NetSendQueueMsg,   bus_ring_len(Q_NET_SEND_LEN)>   netSendRing;
+  SpscRing<AudioCmdQueueMsg,  bus_ring_len(Q_AUDIO_CMD_LEN)>  audioCmdRing;
+  SpscRing<LightCmdQueueMsg,  bus_ring_len(Q_LIGHT_CMD_LEN)>  lightCmdRing;
+  SpscRing<MotorCmdQueueMsg,  bus_ring_len(Q_MOTOR_CMD_LEN)>  motorCmdRing;
+
+  TaskHandle_t showInputProducer = nullptr;
+  TaskHandle_t netSendProducer   = nullptr;
+  TaskHandle_t audioCmdProducer  = nullptr;
+  TaskHandle_t lightCmdProducer  = nullptr;
+  TaskHandle_t motorCmdProducer  = nullptr;
+
+  // Health counters, indexed by BusQueue.
+  QueueStats stats[NUM_BUS_QUEUES];
+};
+
+// Global instance (defined in CommandQueues.cpp)
+extern QueueBus queueBus;
+
+// Health counter hooks, used by the typed wrappers below.
+void queue_stats_sent(BusQueue id, size_t depth, bool ok);
+void queue_stats_sent_isr(BusQueue id, size_t depth, bool ok);
+void queue_stats_received(BusQueue id, uint32_t stampUs);
+void queue_stats_coalesced(BusQueue id, uint32_t count);
+
+// Consistent copy of one queue's counters.
+QueueStats queue_stats_get(BusQueue id);
+
+// Clear all queue counters.
+void queue_stats_reset();
+
+// Name, configured depth (ring + queue) and items waiting of a bus queue.
+const char* queue_name(BusQueue id);
+UBaseType_t queue_length(BusQueue id);
+size_t queue_depth(BusQueue id);
+
+// Time iterations send/receive pairs through a FreeRTOS queue and through an
+// SPSC ring in the calling task, and print the cycles per message of each.
+void queue_benchmark(uint32_t iterations);
+
+// Summary for telemetry: total dropped sends (saturating) and the fullest
+// any queue has been, in percent of its depth.
+uint16_t queue_stats_total_failed();
+uint8_t  queue_stats_worst_fill_pct();
+
+// Print the health table for all queues to the console.
+void print_queue_stats();
+
 // ===== Lifecycle =====
-// Create all queues (returns true if all succeed)
+// Create all queues in static storage (returns true if all succeed)
 bool QueueBus_Init(QueueBus& bus);
 
+// Static storage taken by the bus queues (and the benchmark's queue).
+static constexpr size_t QUEUE_BUS_RAM_BYTES =
+    StaticQueue<ShowInputQueueMsg, bus_queue_len(Q_SHOW_INPUT_LEN)>::RAM_BYTES +
+    StaticQueue<NetSendQueueMsg,   bus_queue_len(Q_NET_SEND_LEN)>::RAM_BYTES +
+    StaticQueue<AudioCmdQueueMsg,  bus_queue_len(Q_AUDIO_CMD_LEN)>::RAM_BYTES +
+    StaticQueue<LightCmdQueueMsg,  bus_queue_len(Q_LIGHT_CMD_LEN)>::RAM_BYTES +
+    StaticQueue<MotorCmdQueueMsg,  bus_queue_len(Q_MOTOR_CMD_LEN)>::RAM_BYTES +
+    StaticQueue<LightCmdQueueMsg,  bus_queue_len(Q_LIGHT_CMD_LEN)>::RAM_BYTES;
+
+// ===== Consumer wakeups =====
+// Consumers never poll their queues.  Each blocks in bus_wait() on its task
+// notification bits, with a timeout only when it has a frame to render, and
+// drains its queue whenever its bus's command bit is set.  Every bus has its
+// own bit, so consumers sharing one task (the frame executor) only wake and
+// re-anchor for their own commands.
+static constexpr uint32_t BUS_EVT_SYNC = 0x02;  // Restart the frame clock now
+
+// A command was queued on bus id.
+static constexpr uint32_t bus_evt_cmd(BusQueue id) {
+  return 0x04u << static_cast<uint32_t>(id);
+}
+
+inline void bus_notify(TaskHandle_t t, uint32_t bits) {
+  if (t) xTaskNotify(t, bits, eSetBits);
+}
+inline void bus_notify_isr(TaskHandle_t t, uint32_t bits, BaseType_t* hpw) {
+  if (t) xTaskNotifyFromISR(t, bits, eSetBits, hpw);
+}
+
+// Block the calling consumer until notified or the timeout expires.
+// Returns the BUS_EVT_* bits received (0 on timeout).
+inline uint32_t bus_wait(TickType_t to) {
+  uint32_t bits = 0;
+  prof_wait_begin();
+  const BaseType_t ok = xTaskNotifyWait(0, UINT32_MAX, &bits, to);
+  prof_wait_end();
+  return ok == pdPASS ? bits : 0;
+}
+
 // ===== Generic helpers =====
 inline bool qsend(QueueHandle_t q, const void* item, TickType_t to=0) {
   return xQueueSend(q, item, to) == pdPASS;
 }
+
 inline bool qrecv(QueueHandle_t q, void* item, TickType_t to=portMAX_DELAY) {
   return xQueueReceive(q, item, to) == pdPASS;
 }
@@ -70,16 +201,70 @@ inline bool qsend_isr(QueueHandle_t q, const void* item, BaseType_t* hpw=nullptr
   return xQueueSendFromISR(q, item, hpw) == pdPASS;
 }
 
+// Stamp, send, count and wake the consumer.  The registered producer goes
+// through the ring, which never blocks (the timeout only applies to the
+// queue path).
+inline uint32_t bus_stamp_us() { return (uint32_t)esp_timer_get_time(); }
+
+template <typename T, size_t N>
+inline bool bus_send(BusQueue id, QueueHandle_t q, SpscRing<T, N>& ring, TaskHandle_t producer,
+                     TaskHandle_t consumer, const T& m, TickType_t to) {
+  T stamped = m;
+  stamped.stampUs = bus_stamp_us();
+  const bool ok = (producer && producer == xTaskGetCurrentTaskHandle())
+                      ? ring.push(stamped)
+                      : qsend(q, &stamped, to);
+  queue_stats_sent(id, ring.size() + uxQueueMessagesWaiting(q), ok);
+  if (ok) bus_notify(consumer, bus_evt_cmd(id));
+  return ok;
+}
+template <typename T, size_t N>
+inline bool bus_send_isr(BusQueue id, QueueHandle_t q, const SpscRing<T, N>& ring, TaskHandle_t consumer,
+                         const T& m, BaseType_t* hpw) {
+  T stamped = m;
+  stamped.stampUs = bus_stamp_us();
+  const bool ok = qsend_isr(q, &stamped, hpw);
+  queue_stats_sent_isr(id, ring.size() + uxQueueMessagesWaitingFromISR(q), ok);
+  if (ok) bus_notify_isr(consumer, bus_evt_cmd(id), hpw);
+  return ok;
+}
+// Take whichever of the ring head and queue head was sent first, so a
+// console "stop" is never overtaken by an older ring command.  Senders only
+// append to the queue, so the item peeked is the one received.
+template <typename T, size_t N>
+inline bool bus_take(QueueHandle_t q, SpscRing<T, N>& ring, T& m) {
+  T fromQueue;
+  const bool inRing = ring.peek(m);
+  const bool inQueue = qpeek(q, &fromQueue, 0);
+  if (inRing && (!inQueue || (int32_t)(m.stampUs - fromQueue.stampUs) <= 0)) return ring.pop(m);
+  return inQueue && qrecv(q, &m, 0);
+}
+
+// Never blocks: consumers wait once in bus_wait() for any of their bits and
+// then drain each bus without consuming any other notification bits.
+template <typename T, size_t N>
+inline bool bus_recv(BusQueue id, QueueHandle_t q, SpscRing<T, N>& ring, T& m) {
+  if (!bus_take(q, ring, m)) return false;
+  queue_stats_received(id, m.stampUs);
+  return true;
+}
+
 // ===== Typed convenience wrappers (task context) =====
-inline bool SendShowQueue (const ShowInputQueueMsg&  m, TickType_t to=0) { return qsend(queueBus.showInputQueueHandle, &m, to); }
-inline bool SendNetQueue  (const NetSendQueueMsg&    m, TickType_t to=0) { return qsend(queueBus.netSendQueueHandle,   &m, to); }
-inline bool SendAudioQueue(const AudioCmdQueueMsg&   m, TickType_t to=0) { return qsend(queueBus.audioCmdQueueHandle,  &m, to); }
-inline bool SendLightQueue(const LightCmdQueueMsg&   m, TickType_t to=0) { return qsend(queueBus.lightCmdQueueHandle,  &m, to); }
-inline bool SendMotorQueue(const MotorCmdQueueMsg&   m, TickType_t to=0) { return qsend(queueBus.motorCmdQueueHandle,  &m, to); }
+inline bool SendShowQueue (const ShowInputQueueMsg&  m, TickType_t to=0) { return bus_send(BusQueue::ShowInput, queueBus.showInputQueueHandle, queueBus.showInputRing, queueBus.showInputProducer, queueBus.showInputConsumer, m, to); }
+inline bool SendNetQueue  (const NetSendQueueMsg&    m, TickType_t to=0) { return bus_send(BusQueue::NetSend,   queueBus.netSendQueueHandle,   queueBus.netSendRing, queueBus.netSendProducer, queueBus.netSendConsumer,   m, to); }
+inline bool SendAudioQueue(const AudioCmdQueueMsg&   m, TickType_t to=0) { return bus_send(BusQueue::Audio,     queueBus.audioCmdQueueHandle,  queueBus.audioCmdRing, queueBus.audioCmdProducer, queueBus.audioCmdConsumer,  m, to); }
+inline bool SendLightQueue(const LightCmdQueueMsg&   m, TickType_t to=0) { return bus_send(BusQueue::Light,     queueBus.lightCmdQueueHandle,  queueBus.lightCmdRing, queueBus.lightCmdProducer, queueBus.lightCmdConsumer,  m, to); }
+inline bool SendMotorQueue(const MotorCmdQueueMsg&   m, TickType_t to=0) { return bus_send(BusQueue::Motor,     queueBus.motorCmdQueueHandle,  queueBus.motorCmdRing, queueBus.motorCmdProducer, queueBus.motorCmdConsumer,  m, to); }
+
+inline bool RecvShowQueue (ShowInputQueueMsg&  m) { return bus_recv(BusQueue::ShowInput, queueBus.showInputQueueHandle, queueBus.showInputRing, m); }
+inline bool RecvNetQueue  (NetSendQueueMsg&    m) { return bus_recv(BusQueue::NetSend,   queueBus.netSendQueueHandle,   queueBus.netSendRing, m); }
+inline bool RecvAudioQueue(AudioCmdQueueMsg&   m) { return bus_recv(BusQueue::Audio,     queueBus.audioCmdQueueHandle,  queueBus.audioCmdRing, m); }
+inline bool RecvLightQueue(LightCmdQueueMsg&   m) { return bus_recv(BusQueue::Light,     queueBus.lightCmdQueueHandle,  queueBus.lightCmdRing, m); }
+inline bool RecvMotorQueue(MotorCmdQueueMsg&   m) { return bus_recv(BusQueue::Motor,     queueBus.motorCmdQueueHandle,  queueBus.motorCmdRing, m); }
 
 // ===== Typed convenience wrappers (ISR context) =====
-inline bool SendShowQueueFromISR (const ShowInputQueueMsg&  m, BaseType_t* hpw=nullptr){ return qsend_isr(queueBus.showInputQueueHandle, &m, hpw); }
-inline bool SendNetQueueFromISR  (const NetSendQueueMsg&    m, BaseType_t* hpw=nullptr){ return qsend_isr(queueBus.netSendQueueHandle,   &m, hpw); }
-inline bool SendAudioQueueFromISR(const AudioCmdQueueMsg&   m, BaseType_t* hpw=nullptr){ return qsend_isr(queueBus.audioCmdQueueHandle,  &m, hpw); }
-inline bool SendLightQueueFromISR(const LightCmdQueueMsg&   m, BaseType_t* hpw=nullptr){ return qsend_isr(queueBus.lightCmdQueueHandle,  &m, hpw); }
-inline bool SendMotorQueueFromISR(const MotorCmdQueueMsg&   m, BaseType_t* hpw=nullptr){ return qsend_isr(queueBus.motorCmdQueueHandle,  &m, hpw); }
+inline bool SendShowQueueFromISR (const ShowInputQueueMsg&  m, BaseType_t* hpw=nullptr){ return bus_send_isr(BusQueue::ShowInput, queueBus.showInputQueueHandle, queueBus.showInputRing, queueBus.showInputConsumer, m, hpw); }
+inline bool SendNetQueueFromISR  (const NetSendQueueMsg&    m, BaseType_t* hpw=nullptr){ return bus_send_isr(BusQueue::NetSend,   queueBus.netSendQueueHandle,   queueBus.netSendRing,   queueBus.netSendConsumer,   m, hpw); }
+inline bool SendAudioQueueFromISR(const AudioCmdQueueMsg&   m, BaseType_t* hpw=nullptr){ return bus_send_isr(BusQueue::Audio,     queueBus.audioCmdQueueHandle,  queueBus.audioCmdRing,  queueBus.audioCmdConsumer,  m, hpw); }
+inline bool SendLightQueueFromISR(const LightCmdQueueMsg&   m, BaseType_t* hpw=nullptr){ return bus_send_isr(BusQueue::Light,     queueBus.lightCmdQueueHandle,  queueBus.lightCmdRing,  queueBus.lightCmdConsumer,  m, hpw); }
+inline bool SendMotorQueueFromISR(const MotorCmdQueueMsg&   m, BaseType_t* hpw=nullptr){ return bus_send_isr(BusQueue::Motor,     queueBus.motorCmdQueueHandle,  queueBus.motorCmdRing,  queueBus.motorCmdConsumer,  m, hpw); }
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include "Logging.h"
+#include "StaticAlloc.h"
 
 
 // ==== Tunables (raise if you need more) ====
@@ -14,6 +15,15 @@
 #ifndef CON_MAX_CMD
 #define CON_MAX_CMD    32     // max length of the command token
 #endif
+#ifndef CON_QUEUE_LEN
+#define CON_QUEUE_LEN  8      // parsed commands waiting for the executor
+#endif
+#ifndef CON_POLL_MS
+#define CON_POLL_MS    20     // serial input poll period
+#endif
+#ifndef CON_POLL_SLACK_MS
+#define CON_POLL_SLACK_MS 10  // poll may run this late to share a wakeup
+#endif
 
 // One parsed console message: command + argv[], all as plain C strings.
 struct CommandMsg {
@@ -22,13 +32,13 @@ struct CommandMsg {
   char    argv[CON_MAX_ARGS][CON_MAX_TOK];  // argument tokens as-is
 };
 
-// Start the console reader (prompts via io_printf). It pushes CommandMsg to a queue.
+// Static storage taken by the command queue.
+static constexpr size_t CONSOLE_QUEUE_RAM_BYTES = StaticQueue<CommandMsg, CON_QUEUE_LEN>::RAM_BYTES;
+
+// Start the console reader (prompts via io_printf). It polls the serial port
+// from the timer service and pushes CommandMsg to a queue.
 // Returns the queue handle (read in your executor task) or nullptr on error.
-QueueHandle_t console_start(
-  size_t queue_len = 16,
-  UBaseType_t task_priority = 2,
-  uint32_t stack_bytes = 4096,
-  BaseType_t core = 0 );
+QueueHandle_t console_start();
 
 // Access the queue after start.
 QueueHandle_t console_get_queue();
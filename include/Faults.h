@@ -16,7 +16,8 @@ typedef enum {
   FAULT_MP3_PLAYER_INIT_FAIL = 10,
   FAULT_OTA_TASK_FAULT = 11,
   FAULT_MOTOR_INIT_FAULT = 12,
-  FAULT_MAX_INDEX = 13
+  FAULT_TIMER_SERVICE_FAULT = 13,
+  FAULT_MAX_INDEX = 14
 } SYSTEM_FAULT_T;
 
 // Forward reference to master system fault bits in master .ini file.
@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+
+//
+// FleetClock provides a shared show clock across all arches.
+//
+// Each node follows the lowest numbered node it can hear (the leader).  The
+// leader's fleet time is simply its own clock.  Pings are the leader beacon:
+// every ping carries the sender's fleet time, which elects the leader and
+// gives a coarse one-way offset as soon as the leader is heard.
+//
+// Followers then refine the offset with a request/response exchange, as in
+// NTP.  A TIME_REQ carries our clock at transmit (t1).  The leader answers
+// with its fleet time when the request arrived (t2) and when the answer left
+// (t3), and we note our clock when the answer arrives (t4):
+//   offset = ((t2 - t1) + (t3 - t4)) / 2     fleet - local
+//   rtt    = (t4 - t1) - (t3 - t2)           time spent on the network
+// The network delay cancels as long as it is the same both ways.  All four
+// timestamps are taken on the net task next to the socket, so queueing in
+// the dispatcher does not count.
+//
+// WiFi power save and queueing only ever add delay, and rarely evenly both
+// ways, so slow exchanges are dropped: one is kept only if its round trip is
+// within a quarter plus 500 us of the fastest of the last 16.  A least
+// squares line is fitted through the last 16 kept (local time, offset)
+// points.  Its slope is the drift between the two crystals, used once the
+// points span at least 4 s and clamped to 200 ppm.  Its value at the newest
+// point is the offset.  Between exchanges the offset is carried forward
+// along that slope.
+//
+// Scheduled events (such as trigger start times) are expressed in fleet
+// milliseconds so all nodes act at the same instant.
+//
+
+// How long a leader may stay silent before we fall back to the next one.
+static constexpr uint32_t FLEET_LEADER_TIMEOUT_MS = 5000;
+
+// Call fleet_clock_sync_target() this often.  Requests go out on every call
+// until the filter window is full, then only on the beat calls.
+static constexpr uint32_t FLEET_SYNC_FAST_MS = 250;
+
+// Current time on the shared fleet clock, in microseconds.
+uint64_t fleet_time_us();
+
+// Current time on the shared fleet clock, in milliseconds (low 32 bits).
+uint32_t fleet_time_ms();
+
+// Fleet time at a given local esp_timer_get_time().
+uint64_t fleet_from_local_us(uint64_t local_us);
+
+// Convert a fleet clock time to the equivalent local millis() time.
+uint32_t fleet_to_local_ms(uint32_t fleet_ms);
+
+// Feed a fleet timestamp carried in a ping from node src, received at
+// local time rx_local_ms.
+void fleet_clock_observe(uint8_t src, uint32_t peer_fleet_ms, uint32_t rx_local_ms);
+
+// Node to send a TIME_REQ to now, or 0xFF for none (we lead, or not due).
+// beat marks the calls a settled clock sends on (once a second, with the
+// ping, so both go out in one batch).
+uint8_t fleet_clock_sync_target(bool beat);
+
+// Responder: a TIME_REQ from src sent at its t1 arrived at rx_local_us.
+// False if src cannot be answered.
+bool fleet_clock_request_rx(uint8_t src, uint64_t t1, uint64_t rx_local_us);
+
+// Responder, at transmit: t1 and t2 of the answer owed to dst.  False if
+// nothing is pending.
+bool fleet_clock_response(uint8_t dst, uint64_t& t1, uint64_t& t2);
+
+// Requester: the answer from src to our request arrived at rx_local_us.
+void fleet_clock_exchange(uint8_t src, uint64_t t1, uint64_t t2, uint64_t t3,
+                          uint64_t rx_local_us);
+
+// Node id currently used as the time reference.
+uint8_t fleet_clock_leader();
+
+// Current estimate of (fleet - local) in milliseconds.
+int32_t fleet_clock_offset_ms();
+
+// Print the leader, offset, drift and exchange stats to the console.
+void fleet_clock_print();
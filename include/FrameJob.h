@@ -0,0 +1,104 @@
+// FrameJob.h
+#pragma once
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "StaticAlloc.h"
+
+//
+// Frame-driven subsystems (light, motor, prox detect, show) as jobs.
+//
+// Each subsystem is split into an init function and a step function.  The
+// step does one frame of work and returns how many ticks until it needs to
+// run again (portMAX_DELAY = only when a command arrives).  The same job can
+// then be run two ways:
+//
+//  - Multi-task (default): one task per job, each blocking in bus_wait().
+//  - Executor (-DUSE_FRAME_EXECUTOR): every job runs on the single FrameExec
+//    task, which sleeps until the earliest job is due or a command lands.
+//    One stack instead of four and no context switches between them.  Each
+//    job only sees its own wake bits, so a light command does not run or
+//    re-anchor the motor job.
+//
+// Both ways time every run the same way, so the `cpu` command's job table
+// compares the two layouts directly:
+//   late   = how long after its due time a timed run started
+//   miss   = timed runs that started more than FRAME_JOB_SLACK_US late
+//   exec   = time spent inside the step
+//
+static constexpr size_t   FRAME_MAX_JOBS     = 4;
+static constexpr uint32_t FRAME_JOB_SLACK_US = 2000;
+
+struct FrameJobStats {
+  uint32_t runs;
+  uint32_t timedRuns;
+  uint32_t misses;
+  uint32_t lateMaxUs;
+  uint64_t lateSumUs;
+  uint32_t execMaxUs;
+  uint64_t execSumUs;
+};
+
+struct FrameJob {
+  const char* name;
+  void       (*init)();                 // Runs once on the job's task
+  TickType_t (*step)(uint32_t events);  // One frame, returns ticks to the next
+  uint32_t    wakeBits;                 // BUS_EVT_* bits that run it early
+
+  // Runtime state, owned by the running task.
+  uint32_t      dueUs;                  // Next timed run (0 = now)
+  bool          idle;                   // No timed run pending
+  FrameJobStats stats;
+};
+
+// Start job on its own task from the TASK_TABLE entry id, or queue it for
+// the executor when built with USE_FRAME_EXECUTOR.
+bool frame_job_start(FrameJob& job, TaskId id);
+
+#if defined(USE_FRAME_EXECUTOR)
+// Start the FrameExec task that runs every job passed to frame_job_start().
+bool frame_exec_start();
+#endif
+
+// Print the per-job timing table.
+void frame_jobs_print();
+
+// ---- Frame pacing shared by the light and motor jobs ----
+//
+// Holds a fixed frame cadence.  A wake by the job's own bits re-anchors the
+// cadence to now so a scheduled step starts on the same frame boundary on every arch;
+// with nothing moving the job sleeps until the next command.
+struct FramePacer {
+  TickType_t frameTicks;
+  TickType_t lastWake;
+  TickType_t lastNow;
+  int32_t    remaining;
+  bool       started;
+
+  explicit FramePacer(TickType_t ticks)
+    : frameTicks(ticks), lastWake(0), lastNow(0), remaining(0), started(false) {}
+
+  // Call at the top of each step with the bits the step was woken by.
+  void begin(uint32_t events)
+  {
+    const TickType_t now = xTaskGetTickCount();
+    if (!started || events != 0)
+    {
+      lastWake = now;
+      started = true;
+    }
+    else
+    {
+      lastWake = (remaining > 0) ? (lastWake + frameTicks) : lastNow;
+    }
+  }
+
+  // Call at the end of each step.  Returns the ticks to wait.
+  TickType_t next(bool moving)
+  {
+    lastNow = xTaskGetTickCount();
+    remaining = (int32_t)(lastWake + frameTicks - lastNow);
+    if (!moving) return portMAX_DELAY;
+    return (remaining > 0) ? (TickType_t)remaining : 0;
+  }
+};
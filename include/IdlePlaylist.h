@@ -0,0 +1,192 @@
+// IdlePlaylist.h — header-only weighted random idle scene picker
+//
+// Usage:
+//   static const IdleCandidate kIdle[] = {
+//     // { step (duration = minimum ms), maximum ms, weight }
+//     { { 20000, LightAnim::FLAMES, AudioAnim::FIRE, MotorAnim::HOME }, 40000, 3 },
+//     ...
+//   };
+//   static IdlePlaylist<2, 1> playlist(kIdle, SEED);
+//   AnimationStep step;
+//   playlist.next(fleet_time_ms(), step);
+//
+// Notes:
+// - Picks are O(1): the weights are turned into a Vose alias table once at
+//   construction, so each pick is one random column plus one coin flip no
+//   matter how many candidates there are.
+// - The last NO_REPEAT picks are skipped by redrawing.  The redraws are
+//   bounded; if they all land on recent scenes the next eligible index after
+//   the last draw is taken instead, so a recent scene is never repeated.
+// - Picks are a pure function of (seed, fleet time slot, history).  Every
+//   arch runs the same firmware seed and the step durations are rounded so
+//   each scene ends on a fleet slot boundary.  Arches that start idling at
+//   the same fleet slot with the same history walk the same sequence without
+//   any network traffic.  The sequence is not fleet-wide though: an arch
+//   whose history differs (it booted or resumed idling at another time) can
+//   redraw differently, which also changes its durations, so it follows its
+//   own sequence from then on.
+
+#pragma once
+#include <Arduino.h>
+#include "AnimationStep.h"
+
+// One idle scene the playlist may choose.
+struct IdleCandidate {
+  AnimationStep step;     // step.duration_ms is the minimum scene length
+  uint32_t maxDurationMs; // upper bound on the scene length
+  uint16_t weight;        // relative pick weight, 0 = never picked
+};
+
+template <size_t N, size_t NO_REPEAT>
+class IdlePlaylist
+{
+public:
+  static_assert(N > 0 && N < 255, "Playlist must have 1..254 candidates");
+  static_assert(NO_REPEAT < N, "No-repeat window must leave a candidate to pick");
+
+  // Scene boundaries land on multiples of this fleet time.
+  static constexpr uint32_t SLOT_MS = 1000;
+
+  IdlePlaylist(const IdleCandidate (&candidates)[N], uint32_t seed)
+    : cand_(candidates), seed_(seed)
+  {
+    buildAliasTable();
+    reset();
+  }
+
+  // Forget the no-repeat history.
+  void reset()
+  {
+    memset(history_, NONE, sizeof(history_));
+    historyNext_ = 0;
+  }
+
+  // Choose the scene starting at fleet time nowMs.  Fills out with the scene
+  // and a duration that ends on the slot grid.  Returns the candidate index.
+  uint8_t next(uint32_t nowMs, AnimationStep& out)
+  {
+    const uint32_t slot = (nowMs + SLOT_MS / 2) / SLOT_MS;
+    uint32_t rnd = mix(seed_ ^ (slot * 0x9E3779B9u));
+
+    uint8_t pick = draw(rnd);
+    for (uint8_t tries = 1; tries < MAX_DRAWS && recent(pick); tries++)
+    {
+      rnd = mix(rnd + 0x6D2B79F5u);
+      pick = draw(rnd);
+    }
+    if (recent(pick)) pick = nextEligible(pick);
+    remember(pick);
+
+    const IdleCandidate& c = cand_[pick];
+    uint32_t minSlots = (c.step.duration_ms + SLOT_MS - 1) / SLOT_MS;
+    if (minSlots == 0) minSlots = 1;
+    uint32_t maxSlots = c.maxDurationMs / SLOT_MS;
+    if (maxSlots < minSlots) maxSlots = minSlots;
+
+    rnd = mix(rnd ^ 0x85EBCA6Bu);
+    const uint32_t slots = minSlots + rnd % (maxSlots - minSlots + 1);
+
+    out = c.step;
+    out.duration_ms = (slot + slots) * SLOT_MS - nowMs;
+    return pick;
+  }
+
+private:
+  static constexpr uint8_t  NONE = 0xFF;
+  static constexpr uint8_t  MAX_DRAWS = 8;
+  static constexpr uint32_t ONE = 0x10000;   // probability 1.0 in 16.16
+
+  // Integer finalizer (lowbias32).  Cheap and well mixed.
+  static uint32_t mix(uint32_t x)
+  {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+  }
+
+  // One alias table lookup: high bits choose the column, low bits the coin.
+  uint8_t draw(uint32_t rnd) const
+  {
+    const uint8_t col = (uint8_t)(((rnd >> 16) * N) >> 16);
+    return ((rnd & 0xFFFF) < prob_[col]) ? col : alias_[col];
+  }
+
+  bool recent(uint8_t idx) const
+  {
+    for (size_t i = 0; i < NO_REPEAT; i++)
+    {
+      if (history_[i] == idx) return true;
+    }
+    return false;
+  }
+
+  // First index after idx that is not recent, preferring weighted entries.
+  // NO_REPEAT < N guarantees one exists.
+  uint8_t nextEligible(uint8_t idx) const
+  {
+    for (size_t i = 1; i < N; i++)
+    {
+      const uint8_t c = (uint8_t)((idx + i) % N);
+      if (cand_[c].weight && !recent(c)) return c;
+    }
+    for (size_t i = 1; i < N; i++)
+    {
+      const uint8_t c = (uint8_t)((idx + i) % N);
+      if (!recent(c)) return c;
+    }
+    return idx;
+  }
+
+  void remember(uint8_t idx)
+  {
+    if (NO_REPEAT == 0) return;
+    history_[historyNext_] = idx;
+    historyNext_ = (historyNext_ + 1) % NO_REPEAT;
+  }
+
+  // Vose's alias method with 16.16 fixed point probabilities.
+  void buildAliasTable()
+  {
+    uint32_t total = 0;
+    for (size_t i = 0; i < N; i++) total += cand_[i].weight;
+
+    uint32_t scaled[N];
+    uint8_t small[N], large[N];
+    size_t nSmall = 0, nLarge = 0;
+
+    for (size_t i = 0; i < N; i++)
+    {
+      // All-zero weights fall back to an even spread.
+      const uint32_t w = total ? cand_[i].weight : 1;
+      const uint32_t t = total ? total : N;
+      scaled[i] = (uint32_t)(((uint64_t)w * N * ONE) / t);
+      if (scaled[i] < ONE) small[nSmall++] = (uint8_t)i;
+      else                 large[nLarge++] = (uint8_t)i;
+    }
+
+    while (nSmall && nLarge)
+    {
+      const uint8_t s = small[--nSmall];
+      const uint8_t l = large[--nLarge];
+      prob_[s]  = scaled[s];
+      alias_[s] = l;
+      scaled[l] -= ONE - scaled[s];
+      if (scaled[l] < ONE) small[nSmall++] = l;
+      else                 large[nLarge++] = l;
+    }
+
+    // Leftovers are full columns (rounding residue lands here too).
+    while (nLarge) { const uint8_t l = large[--nLarge]; prob_[l] = ONE; alias_[l] = l; }
+    while (nSmall) { const uint8_t s = small[--nSmall]; prob_[s] = ONE; alias_[s] = s; }
+  }
+
+  const IdleCandidate (&cand_)[N];
+  const uint32_t seed_;
+  uint32_t prob_[N];
+  uint8_t  alias_[N];
+  uint8_t  history_[NO_REPEAT ? NO_REPEAT : 1];
+  size_t   historyNext_ = 0;
+};
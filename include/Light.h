@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "NodeProfile.h"
 
 // Light animation show indices.
 enum class LightAnim : uint8_t { 
@@ -15,9 +16,12 @@ enum class LightAnim : uint8_t {
 static constexpr uint8_t NUM_LIGHT_ANIMATIONS = static_cast<uint8_t>(LightAnim::COUNT);
 
 
-// Starts the light task that drives the addressable LED hardware.
+// Starts the light task that drives the addressable LED strip model.
 //
-// Returns: true on success, false on failure.
-bool light_start(UBaseType_t priority = 2,
-                uint32_t stack_bytes = 4096,
-                BaseType_t core = 1);
+// Returns: true on success, false on failure (or no strip).
+bool light_start(StripModel model);
+
+// Wakes the light task to render immediately and re-phases its frame clock
+// to now.  Used by the show so a scheduled step starts on the same frame
+// boundary on every arch.
+void light_frame_sync();
@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "NodeProfile.h"
 
 
 // Motor animation show indices.
@@ -12,9 +13,7 @@ enum class MotorAnim : uint8_t {
 static constexpr uint8_t NUM_MOTOR_ANIMATIONS = static_cast<uint8_t>(MotorAnim::COUNT);
 
 
-// Starts the motor task that drives the motor hardware.
+// Starts the motor task that drives the motor outputs fitted per type.
 //
-// Returns: true on success, false on failure.
-bool motor_start(UBaseType_t priority = 2,
-                uint32_t stack_bytes = 4096,
-                BaseType_t core = 1);
+// Returns: true on success, false on failure (or no motor).
+bool motor_start(MotorType type);
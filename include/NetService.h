@@ -5,15 +5,82 @@
 #include <WiFi.h>
 #include <WiFiUdp.h>
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "CommandQueues.h"
+#include "esp_timer.h"
+#include "esp_vfs_eventfd.h"
 #include "esp_wifi.h"
+#include "IoSync.h"
+#include "lwip/sockets.h"
+#include "Protocol.h"
+#include "SpscRing.h"
+#include "TaskProfiler.h"
 
 class NetService
 {
 public:
-  // C-style callback (fast, no heap). Runs in the NetService task context (use core 0).
-  // Keep it short; if you need heavy work, defer to another task/queue.
-  typedef void (*PacketCallback)(const uint8_t *data, size_t len,
-                                 const IPAddress &from, void *user);
+  // ---- Receive buffers ----
+  // The net task receives straight into a buffer from a fixed pool, parses
+  // it in place and hands it to the dispatcher task.  The buffer returns to
+  // the pool when the callback returns, or when the last retain() is
+  // released.  When the pool is empty, datagrams are dropped and counted.
+  // A slow handler can never stall the socket.
+  static constexpr size_t RX_POOL_SIZE = 8;
+
+  struct RxPacket
+  {
+    uint8_t     data[Proto::MAX_FRAME + 1];   // Spare byte flags oversize datagrams
+    size_t      len = 0;
+    IPAddress   from;
+    uint64_t    rxUs = 0;                     // esp_timer_get_time() when read off the socket
+    Proto::View view;                         // payload points into data
+  };
+
+  // C-style callback (no heap, no copy). Runs on the dispatcher task.
+  // To keep the packet past the callback, retain() it and release() it when done.
+  typedef void (*PacketCallback)(const RxPacket &pkt, void *user);
+
+  // ---- Transmit ----
+  // Any task posts a NetSendQueueMsg to the bus net queue with post(); it
+  // never blocks.  The net task drains the queue in bursts, calls the frame
+  // builder for each message just before it goes out (so timestamps in the
+  // frame are taken at the transmit moment) and sends it.  Messages drained
+  // in the same burst share one batch datagram (Proto::BatchWriter), so a
+  // group costs one WiFi transmission instead of several.  Frames still
+  // queued after TX_MAX_AGE_MS are dropped as stale.
+  //
+  // A message with copies > 1 is sent again copies - 1 times, TX_REPEAT_GAP_MS
+  // apart, as the identical frame; receivers drop the extra copies by seq.
+  // The first copy is not delayed, so the added latency is only for the
+  // case where the first is lost, at most (copies - 1) * TX_REPEAT_GAP_MS.
+  static constexpr uint32_t TX_REPEAT_GAP_MS = 8;
+
+  // Build the frame for msg into out with v2 sequence number seq.
+  // Returns the frame length, or 0 to drop the message.
+  typedef size_t (*FrameBuilder)(const NetSendQueueMsg &msg, uint16_t seq, uint8_t *out,
+                                 size_t cap, void *user);
+
+  // ---- Joining ----
+  // At boot the net task first joins the access point and channel of the
+  // last good join directly, skipping the scan, with a static address if
+  // one is set.  Only if that has no address within JOIN_FAST_MS does it
+  // fall back to scanning for the SSID.  The join that worked is passed to
+  // the join callback so it can be cached for the next boot.
+  static constexpr uint32_t JOIN_FAST_MS = 4000;
+
+  struct JoinInfo
+  {
+    uint8_t  bssid[6] = {};
+    uint8_t  channel = 0;     // 0 = nothing cached
+    uint32_t ip = 0;          // Network byte order, as IPAddress stores it
+    uint32_t gw = 0;
+    uint32_t mask = 0;
+  };
+
+  // Runs on the net task once the station has an address.
+  typedef void (*JoinCallback)(const JoinInfo &joined, void *user);
 
   NetService(const String &ssid,
              const String &pass,
@@ -41,18 +108,77 @@ public:
     reinterpret_cast<NetService *>(pv)->run();
   }
 
+  // Join hint and static address (ip 0 = DHCP).  Set before the task
+  // starts.  With dhcpFallback the address is dropped for DHCP if the
+  // direct join fails, for an address that was only a cached lease.
+  void setJoinHint(const JoinInfo &hint) { joinHint_ = hint; }
+  void setStaticIp(uint32_t ip, uint32_t gw, uint32_t mask, bool dhcpFallback)
+  {
+    staticIp_.ip = ip;
+    staticIp_.gw = gw;
+    staticIp_.mask = mask;
+    staticDhcpFallback_ = dhcpFallback;
+  }
+
+  // Register the join callback (optional).
+  void onJoined(JoinCallback fn, void *user = nullptr)
+  {
+    joinCb_ = fn;
+    joinUser_ = user;
+  }
 
-  int send(const uint8_t *data, size_t len)
+  // Register the transmit frame builder.
+  void onTransmit(FrameBuilder fn, void *user = nullptr)
   {
-    if (!WiFi.isConnected())
-      return -1;
-    if (!udpTx_.beginPacket(mcast_, port_))
-      return -2; // <-- multicast OK via beginPacket
-    int w = udpTx_.write(data, len);
-    udpTx_.endPacket();
-    return w;
+    txBuild_ = fn;
+    txUser_ = user;
   }
 
+  // Queue a frame for transmit.  False if the TX queue is full.
+  // Pass more = true when another post follows straight away: the net task
+  // is not woken until the last one, so the group goes out as one batch.
+  bool post(const NetSendQueueMsg &msg, bool more = false)
+  {
+    if (!SendNetQueue(msg))
+      return false;
+    const int fd = txWakeFd_;
+    if (more)
+      return true;
+    if (fd >= 0)
+    {
+      const uint64_t one = 1;
+      (void)write(fd, &one, sizeof(one));
+    }
+    return true;
+  }
+
+  // Dispatcher task entry point; runs the packet callback.
+  static void dispatchTask(void *pv)
+  {
+    reinterpret_cast<NetService *>(pv)->dispatch();
+  }
+
+  // Hold a packet beyond its callback.  Any task may retain or release.
+  void retain(const RxPacket &pkt)
+  {
+    portENTER_CRITICAL(&poolMux_);
+    rxRefs_[&pkt - rxPool_]++;
+    portEXIT_CRITICAL(&poolMux_);
+  }
+
+  void release(const RxPacket &pkt)
+  {
+    const size_t i = &pkt - rxPool_;
+    portENTER_CRITICAL(&poolMux_);
+    if (rxRefs_[i] && --rxRefs_[i] == 0)
+    {
+      rxFree_ |= 1u << i;
+      rxInUse_--;
+    }
+    portEXIT_CRITICAL(&poolMux_);
+  }
+
+
   // Accessor functions for console interface.
   bool        isConnected() const { return WiFi.isConnected(); }
   bool        isListening() const { return listening_; }
@@ -68,6 +194,24 @@ public:
   int32_t     channel() const { return WiFi.channel(); }
   String      mcastIP() const { return mcast_.toString(); }
   uint16_t    mcastPort() const { return port_; }
+  uint32_t    rxPackets() const { return rxPackets_; }
+  uint32_t    rxNoBuffer() const { return rxNoBuffer_; }
+  uint32_t    rxMalformed() const { return rxMalformed_; }
+  uint32_t    rxDuplicates() const { return rxDuplicates_; }
+  uint8_t     rxPoolPeak() const { return rxPeak_; }
+  uint32_t    txSent() const { return txSent_; }
+  uint32_t    txCopies() const { return txCopies_; }
+  uint32_t    txFailed() const { return txFailed_; }
+  uint32_t    txStale() const { return txStale_; }
+  uint32_t    txBursts() const { return txBursts_; }
+  uint8_t     txMaxBurst() const { return txMaxBurst_; }
+  uint32_t    txBatches() const { return txBatches_; }
+  uint32_t    txBatched() const { return txBatched_; }
+  uint32_t    txRepeatTooBig() const { return txRepeatTooBig_; }
+  uint32_t    txRepeatNoSlot() const { return txRepeatNoSlot_; }
+  const char* joinPath() const { return joinPath_; }
+  uint32_t    joinMs() const { return joinMs_; }
+  uint32_t    readyMs() const { return readyMs_; }
 
 
 private:
@@ -85,6 +229,13 @@ private:
     // Join multicast
     (void)startMulticast_();
 
+    // Eventfd that post() writes to pull the task out of select().
+    const esp_vfs_eventfd_config_t evCfg = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    (void)esp_vfs_eventfd_register(&evCfg);   // Already registered is fine
+    txWakeFd_ = eventfd(0, 0);
+    if (txWakeFd_ < 0)
+      ESP_LOGW("NET", "No TX wake eventfd; sends wait for the next receive or health check");
+
     // Re-join multicast when IP is (re)acquired
     WiFi.onEvent([](arduino_event_t *e)
                  {
@@ -92,36 +243,319 @@ private:
                  });
 
     // RX loop
-    static constexpr size_t BUF_SZ = 1472;
-    uint8_t buf[BUF_SZ];
-
     for (;;)
     {
       // If Wi-Fi got dropped, try to reconnect and re-join mcast.
       if (!WiFi.isConnected())
       {
-        listening_ = false;
+        stopMulticast_();
         reconnectLoop_();
-        (void)startMulticast_();
       }
-      else if (!listening_)
+      if (!listening_ && !startMulticast_())
+      {
+        prof_delay(pdMS_TO_TICKS(RX_HEALTH_CHECK_MS));
+        continue;
+      }
+
+      // Send anything posted or due to repeat, then sleep until a datagram
+      // arrives, a frame is posted or a repeat is due, waking on the
+      // timeout otherwise only to recheck the link.
+      transmitQueued_();
+      const uint32_t waitMs = transmitRepeats_();
+
+      // Never hand select() a closed socket.
+      if (rxFd_ < 0)
+      {
+        stopMulticast_();
+        prof_delay(pdMS_TO_TICKS(RX_HEALTH_CHECK_MS));
+        continue;
+      }
+
+      fd_set rfds;
+      FD_ZERO(&rfds);
+      FD_SET(rxFd_, &rfds);
+      int maxFd = rxFd_;
+      const int wakeFd = txWakeFd_;
+      if (wakeFd >= 0)
+      {
+        FD_SET(wakeFd, &rfds);
+        maxFd = max(maxFd, wakeFd);
+      }
+      timeval tv = {(time_t)(waitMs / 1000), (suseconds_t)((waitMs % 1000) * 1000)};
+      prof_wait_begin();
+      int ready = select(maxFd + 1, &rfds, nullptr, nullptr, &tv);
+      prof_wait_end();
+      if (ready == 0)
+        continue;
+      if (ready < 0)
+      {
+        // The socket goes bad when the netif drops; rebuild it.
+        ESP_LOGW("NET", "select failed (errno %d); rejoining multicast", errno);
+        stopMulticast_();
+        continue;
+      }
+
+      if (wakeFd >= 0 && FD_ISSET(wakeFd, &rfds))
+      {
+        uint64_t posts;
+        (void)read(wakeFd, &posts, sizeof(posts));
+      }
+
+      // Drain everything queued before sleeping again.
+      if (FD_ISSET(rxFd_, &rfds))
+      {
+        while (receiveOne_())
+        {
+        }
+      }
+    }
+  }
+
+  // Send every frame waiting on the TX queue in one burst.  Messages
+  // drained together are packed into batch frames of up to MAX_FRAME; a
+  // message alone goes out as its own plain frame.  A batch repeats as many
+  // times as its most repeated message asks.
+  void transmitQueued_()
+  {
+    uint8_t frame[Proto::MAX_FRAME];    // Message just built
+    uint8_t first[Proto::MAX_FRAME];    // First of the datagram, sent plain if alone
+    uint8_t packed[Proto::MAX_FRAME];
+    Proto::BatchWriter batch(packed, sizeof(packed), 0);
+    size_t firstLen = 0;
+    uint8_t copies = 0;
+    uint32_t sentMs = 0;
+    uint8_t burst = 0;
+
+    auto flush = [&]()
+    {
+      if (batch.count() > 1)
+      {
+        Proto::putU32(&packed[6], sentMs);    // Newest record's send time
+        sendDatagram_(packed, batch.size(), copies);
+        txBatches_++;
+        txBatched_ += batch.count();
+      }
+      else if (firstLen)
       {
-        (void)startMulticast_();
+        sendDatagram_(first, firstLen, copies);
       }
+      firstLen = 0;
+      batch = Proto::BatchWriter(packed, sizeof(packed), 0);
+    };
 
-      int packetSize = udpRx_.parsePacket();
-      if (packetSize > 0)
+    NetSendQueueMsg m;
+    while (RecvNetQueue(m))
+    {
+      if (bus_stamp_us() - m.stampUs > TX_MAX_AGE_MS * 1000)
       {
-        int len = udpRx_.read(buf, min((int)BUF_SZ, packetSize));
-        if (len > 0)
+        txStale_++;
+        continue;
+      }
+      const size_t len = txBuild_ ? txBuild_(m, txSeq_, frame, sizeof(frame), txUser_) : 0;
+      if (len == 0)
+      {
+        txFailed_++;
+        continue;
+      }
+      if (burst < UINT8_MAX)
+        burst++;
+
+      if (firstLen)
+      {
+        // A datagram that repeats must fit a repeat slot, so a repeated
+        // message is never packed into a batch too big to send again.
+        const size_t base = batch.count() ? batch.size() : firstLen + Proto::BATCH_RECORD_HDR;
+        const size_t grown = base + Proto::BATCH_RECORD_HDR + len - Proto::HDR_SIZE;
+        const bool repeats = copies > 1 || m.copies > 1;
+        const bool fits = !repeats || grown <= TX_REPEAT_MAX_BYTES;
+        if (fits && batch.count() == 0)
         {
-          lastFirstByte_ = buf[0];
-          lastRxMs_ = millis();
-          if (cb_)
-            cb_(buf, (size_t)len, udpRx_.remoteIP(), user_);
+          batch = Proto::BatchWriter(packed, sizeof(packed), first[2]);
+          batch.add(first, firstLen);
         }
+        if (fits && batch.count() && batch.add(frame, len))
+        {
+          sentMs = Proto::getU32(&frame[6]);
+          if (m.copies > copies)
+            copies = m.copies;
+          continue;
+        }
+        flush();   // No room (or not batchable): this message starts the next datagram
+      }
+      memcpy(first, frame, len);
+      firstLen = len;
+      copies = m.copies;
+    }
+    flush();
+
+    if (burst)
+    {
+      txBursts_++;
+      if (burst > txMaxBurst_)
+        txMaxBurst_ = burst;
+    }
+  }
+
+  // Give a built frame the next sequence number and send it.
+  void sendDatagram_(uint8_t *frame, size_t len, uint8_t copies)
+  {
+    Proto::stampSeq(frame, txSeq_++);
+    if (!sendFrame_(frame, len))
+    {
+      txFailed_++;
+      return;
+    }
+    txSent_++;
+    if (copies > 1)
+      scheduleRepeat_(frame, len, copies - 1);
+  }
+
+  // Keep a sent frame to send again.  Frames too big for a slot, or with no
+  // slot free, go out once only and are counted.
+  void scheduleRepeat_(const uint8_t *frame, size_t len, uint8_t copies)
+  {
+    if (len > TX_REPEAT_MAX_BYTES)
+    {
+      txRepeatTooBig_++;
+      return;
+    }
+    for (TxRepeat &r : txRepeats_)
+    {
+      if (r.left == 0)
+      {
+        memcpy(r.frame, frame, len);
+        r.len = (uint8_t)len;
+        r.left = copies;
+        r.dueUs = bus_stamp_us() + TX_REPEAT_GAP_MS * 1000;
+        return;
+      }
+    }
+    txRepeatNoSlot_++;
+  }
+
+  // Send the repeats that are due.  Returns ms until the next one, capped
+  // at the health check interval.
+  uint32_t transmitRepeats_()
+  {
+    uint32_t waitMs = RX_HEALTH_CHECK_MS;
+    const uint32_t now = bus_stamp_us();
+    for (TxRepeat &r : txRepeats_)
+    {
+      if (r.left == 0)
+        continue;
+      int32_t leftUs = (int32_t)(r.dueUs - now);
+      if (leftUs <= 0)
+      {
+        if (sendFrame_(r.frame, r.len))
+          txCopies_++;
+        else
+          txFailed_++;
+        r.left--;
+        r.dueUs += TX_REPEAT_GAP_MS * 1000;
+        if (r.left == 0)
+          continue;
+        leftUs = TX_REPEAT_GAP_MS * 1000;
+      }
+      const uint32_t ms = ((uint32_t)leftUs + 999) / 1000;
+      if (ms < waitMs)
+        waitMs = ms;
+    }
+    return waitMs;
+  }
+
+  bool sendFrame_(const uint8_t *data, size_t len)
+  {
+    if (!WiFi.isConnected())
+      return false;
+    if (!udpTx_.beginPacket(mcast_, port_))
+      return false;
+    udpTx_.write(data, len);
+    return udpTx_.endPacket();
+  }
+
+  // Receive one datagram into a pool buffer and queue it for dispatch.
+  // Returns false once the socket is empty.
+  bool receiveOne_()
+  {
+    RxPacket *p = acquire_();
+    if (!p)
+    {
+      // Pool exhausted: discard the datagram so the socket keeps draining.
+      uint8_t discard;
+      if (recvfrom(rxFd_, &discard, 1, MSG_DONTWAIT, nullptr, nullptr) < 0)
+        return false;
+      rxNoBuffer_++;
+      return true;
+    }
+
+    sockaddr_in from = {};
+    socklen_t fromLen = sizeof(from);
+    int len = recvfrom(rxFd_, p->data, sizeof(p->data), MSG_DONTWAIT, (sockaddr *)&from, &fromLen);
+    if (len <= 0)
+    {
+      release(*p);
+      return false;
+    }
+
+    p->rxUs = (uint64_t)esp_timer_get_time();
+    rxPackets_++;
+    if (rxInUse_ > rxPeak_)
+      rxPeak_ = rxInUse_;
+    lastFirstByte_ = p->data[0];
+    lastRxMs_ = millis();
+    p->len = (size_t)len;
+    p->from = IPAddress((uint32_t)from.sin_addr.s_addr);
+    if (p->len > Proto::MAX_FRAME || !Proto::parse(p->data, p->len, p->view))
+    {
+      rxMalformed_++;
+      release(*p);
+      return true;
+    }
+    if (!rxDups_.accept(p->view.hdr))
+    {
+      rxDuplicates_++;
+      release(*p);
+      return true;
+    }
+
+    rxReady_.push((uint8_t)(p - rxPool_));   // Never full: it holds at most the pool
+    TaskHandle_t d = dispatcher_;
+    if (d)
+      xTaskNotifyGive(d);
+    return true;
+  }
+
+  RxPacket *acquire_()
+  {
+    RxPacket *p = nullptr;
+    portENTER_CRITICAL(&poolMux_);
+    if (rxFree_)
+    {
+      const size_t i = __builtin_ctz(rxFree_);
+      rxFree_ &= ~(1u << i);
+      rxRefs_[i] = 1;
+      rxInUse_++;
+      p = &rxPool_[i];
+    }
+    portEXIT_CRITICAL(&poolMux_);
+    return p;
+  }
+
+  void dispatch()
+  {
+    dispatcher_ = xTaskGetCurrentTaskHandle();
+    for (;;)
+    {
+      uint8_t i;
+      while (rxReady_.pop(i))
+      {
+        if (cb_)
+          cb_(rxPool_[i], user_);
+        release(rxPool_[i]);
       }
-      vTaskDelay(pdMS_TO_TICKS(1)); // yield to Wi-Fi/LwIP
+      prof_wait_begin();
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      prof_wait_end();
     }
   }
 
@@ -129,13 +563,7 @@ private:
   void connectWifiBlocking_()
   {
     ESP_LOGI("NET", "Connecting to '%s'...", ssid_.c_str());
-
-    // Clean start
-    WiFi.disconnect(true /*wifioff*/, true /*eraseNVS*/);
-    vTaskDelay(pdMS_TO_TICKS(200));
-    WiFi.persistent(false);
-    WiFi.mode(WIFI_STA);
-    WiFi.setSleep(false);
+    const uint32_t start = millis();
 
     // Ensure we scan the channels your AP may use (US=1..11; EU=1..13).
     wifi_country_t ctry = {"US", 1, 11, WIFI_COUNTRY_POLICY_AUTO};
@@ -152,68 +580,97 @@ private:
       ESP_LOGI("NET", "got IP: %s", WiFi.localIP().toString().c_str());
     } });
 
-    // Scan for the target SSID (include hidden=true so beacons off-net still show when possible)
-    int n = WiFi.scanNetworks(/*async=*/false, /*hidden=*/true);
-    int idx = -1;
-    for (int i = 0; i < n; ++i)
+    // A static address skips DHCP, on the fast path and the fallback alike.
+    if (staticIp_.ip)
     {
-      if (WiFi.SSID(i) == ssid_)
-      {
-        idx = i;
-        break;
-      }
+      WiFi.config(IPAddress(staticIp_.ip), IPAddress(staticIp_.gw), IPAddress(staticIp_.mask),
+                  IPAddress(staticIp_.gw));
     }
 
-    if (idx >= 0)
+    bool joined = false;
+    if (joinHint_.channel)
     {
-      const uint8_t *bssid = WiFi.BSSID(idx);
-      int ch = WiFi.channel(idx);
-      int rssi = WiFi.RSSI(idx);
-      ESP_LOGI("NET", "found SSID on ch=%d RSSI=%d, joining via BSSID=%02X:%02X:%02X:%02X:%02X:%02X\n",
-           ch, rssi, bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
-     
-      WiFi.begin(ssid_.c_str(), pass_.c_str(), ch, bssid, true /*connect*/);
-    }
-    else
-    {
-      ESP_LOGW("NET", "SSID not found in scan; trying blind connect (hidden or 5 GHz?)");
-      WiFi.begin(ssid_.c_str(), pass_.c_str());
+      const uint8_t *b = joinHint_.bssid;
+      ESP_LOGI("NET", "joining cached BSSID=%02X:%02X:%02X:%02X:%02X:%02X on ch=%u",
+               b[0], b[1], b[2], b[3], b[4], b[5], joinHint_.channel);
+      WiFi.begin(ssid_.c_str(), pass_.c_str(), joinHint_.channel, b, true /*connect*/);
+      joined = waitConnected_(JOIN_FAST_MS);
+      if (joined)
+      {
+        joinPath_ = "cached";
+      }
+      else
+      {
+        ESP_LOGW("NET", "cached join failed; scanning");
+        WiFi.disconnect(false, false);
+        if (staticIp_.ip && staticDhcpFallback_)
+          WiFi.config(IPAddress(), IPAddress(), IPAddress());   // Back to DHCP
+        vTaskDelay(pdMS_TO_TICKS(100));
+      }
     }
 
-    // Wait for connect with periodic retry
-    uint32_t t0 = millis();
-    const uint32_t tryWindowMs = 15000;
-    while (WiFi.status() != WL_CONNECTED)
+    // Wait for connect with periodic rescan and retry
+    while (!joined)
     {
-      vTaskDelay(pdMS_TO_TICKS(200));
-      if (millis() - t0 > tryWindowMs)
+      joinPath_ = beginScanned_() ? "scan" : "blind";
+      joined = waitConnected_(15000);
+      if (!joined)
       {
         ESP_LOGW("NET", "connect timeout; rescanning and retrying...");
-        t0 = millis();
         WiFi.disconnect(false, false);
         vTaskDelay(pdMS_TO_TICKS(300));
-        // Re-run the scan + BSSID selection
-        int n2 = WiFi.scanNetworks(false, true);
-        int j = -1;
-        for (int i = 0; i < n2; ++i)
-          if (WiFi.SSID(i) == ssid_)
-          {
-            j = i;
-            break;
-          }
-        if (j >= 0)
-        {
-          const uint8_t *b = WiFi.BSSID(j);
-          int ch = WiFi.channel(j);
-          WiFi.begin(ssid_.c_str(), pass_.c_str(), ch, b, true);
-        }
-        else
-        {
-          WiFi.begin(ssid_.c_str(), pass_.c_str());
-        }
       }
     }
+    joinMs_ = millis() - start;
     ESP_LOGI("NET", "Connected. IP: %s", WiFi.localIP().toString().c_str());
+
+    JoinInfo now;
+    const uint8_t *b = WiFi.BSSID();
+    if (b)
+      memcpy(now.bssid, b, sizeof(now.bssid));
+    now.channel = (uint8_t)WiFi.channel();
+    now.ip = (uint32_t)WiFi.localIP();
+    now.gw = (uint32_t)WiFi.gatewayIP();
+    now.mask = (uint32_t)WiFi.subnetMask();
+    if (joinCb_)
+      joinCb_(now, joinUser_);
+  }
+
+  // Scan for the target SSID and join the BSSID found.  Without a match
+  // (hidden or 5 GHz) begin a blind connect and return false.
+  bool beginScanned_()
+  {
+    // Include hidden=true so beacons off-net still show when possible
+    int n = WiFi.scanNetworks(/*async=*/false, /*hidden=*/true);
+    for (int i = 0; i < n; ++i)
+    {
+      if (WiFi.SSID(i) == ssid_)
+      {
+        const uint8_t *bssid = WiFi.BSSID(i);
+        int ch = WiFi.channel(i);
+        int rssi = WiFi.RSSI(i);
+        ESP_LOGI("NET", "found SSID on ch=%d RSSI=%d, joining via BSSID=%02X:%02X:%02X:%02X:%02X:%02X\n",
+                 ch, rssi, bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+        WiFi.begin(ssid_.c_str(), pass_.c_str(), ch, bssid, true /*connect*/);
+        return true;
+      }
+    }
+    ESP_LOGW("NET", "SSID not found in scan; trying blind connect (hidden or 5 GHz?)");
+    WiFi.begin(ssid_.c_str(), pass_.c_str());
+    return false;
+  }
+
+  // Poll until the station has an address.  False after timeoutMs.
+  bool waitConnected_(uint32_t timeoutMs)
+  {
+    const uint32_t t0 = millis();
+    while (WiFi.status() != WL_CONNECTED)
+    {
+      if (millis() - t0 > timeoutMs)
+        return false;
+      vTaskDelay(pdMS_TO_TICKS(JOIN_POLL_MS));
+    }
+    return true;
   }
 
   void reconnectLoop_()
@@ -234,14 +691,22 @@ private:
     ESP_LOGI("NET", "Reconnected. IP: %s", WiFi.localIP().toString().c_str());
   }
 
+  // Open the receive socket bound to the port and joined to the group on
+  // the station interface.
   bool startMulticast_()
   {
-    udpRx_.stop();
-    bool ok = udpRx_.beginMulticast(mcast_, port_); // <-- only (group, port) on ESP32
+    stopMulticast_();
+    bool ok = openRxSocket_();
     listening_ = ok;
     if (ok)
     {
       ESP_LOGI("NET", "Started multicast, listening on: %s:%u", mcast_.toString().c_str(), port_);
+      if (!readyMs_)
+      {
+        readyMs_ = millis();
+        io_printf("[Net] Joined via %s in %lu ms, multicast ready %lu ms after boot\n",
+                  joinPath_, (unsigned long)joinMs_, (unsigned long)readyMs_);
+      }
     }
     else
     {
@@ -250,7 +715,68 @@ private:
     return ok;
   }
 
+  bool openRxSocket_()
+  {
+    rxFd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (rxFd_ < 0)
+      return false;
+
+    int one = 1;
+    setsockopt(rxFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(rxFd_, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+      stopMulticast_();
+      return false;
+    }
+
+    ip_mreq mreq = {};
+    mreq.imr_multiaddr.s_addr = (uint32_t)mcast_;
+    mreq.imr_interface.s_addr = (uint32_t)WiFi.localIP();
+    if (setsockopt(rxFd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+    {
+      stopMulticast_();
+      return false;
+    }
+    return true;
+  }
+
+  void stopMulticast_()
+  {
+    listening_ = false;
+    if (rxFd_ >= 0)
+      close(rxFd_);
+    rxFd_ = -1;
+  }
+
 private:
+  // How long the receive loop may sleep before rechecking the Wi-Fi link.
+  static constexpr uint32_t RX_HEALTH_CHECK_MS = 500;
+
+  // How often a join in progress is checked for an address.
+  static constexpr uint32_t JOIN_POLL_MS = 20;
+
+  // Frames queued longer than this (e.g. across a reconnect) are dropped.
+  static constexpr uint32_t TX_MAX_AGE_MS = 500;
+
+  // Room for redundant copies in flight.  Only short frames repeat: a
+  // trigger, alone or batched with a ping.  transmitQueued_() keeps a
+  // repeated message out of any batch larger than a slot.
+  static constexpr size_t TX_REPEAT_SLOTS = 4;
+  static constexpr size_t TX_REPEAT_MAX_BYTES = 48;
+
+  struct TxRepeat
+  {
+    uint8_t frame[TX_REPEAT_MAX_BYTES];
+    uint8_t len = 0;
+    uint8_t left = 0;       // Copies still to send
+    uint32_t dueUs = 0;
+  };
+
   String ssid_;
   String pass_;
   IPAddress mcast_;
@@ -261,10 +787,54 @@ private:
   PacketCallback cb_ = nullptr;
   void *user_ = nullptr;
 
-  // UDP sockets
-  WiFiUDP udpRx_;
+  // Joining
+  JoinInfo joinHint_;
+  JoinInfo staticIp_;                   // Only ip, gw and mask are used
+  bool staticDhcpFallback_ = false;
+  JoinCallback joinCb_ = nullptr;
+  void *joinUser_ = nullptr;
+  const char *volatile joinPath_ = "none";
+  volatile uint32_t joinMs_ = 0;
+  volatile uint32_t readyMs_ = 0;       // millis() when multicast first came up
+
+  // UDP sockets.  Receive is a raw lwIP socket so the task can block in
+  // select(); send stays on WiFiUDP, used only by the net task.
+  int rxFd_ = -1;
   WiFiUDP udpTx_;
 
+  // Transmit
+  FrameBuilder txBuild_ = nullptr;
+  void *txUser_ = nullptr;
+  volatile int txWakeFd_ = -1;
+  uint16_t txSeq_ = 0;
+  TxRepeat txRepeats_[TX_REPEAT_SLOTS];
+  volatile uint32_t txSent_ = 0;
+  volatile uint32_t txCopies_ = 0;
+  volatile uint32_t txFailed_ = 0;
+  volatile uint32_t txStale_ = 0;
+  volatile uint32_t txBursts_ = 0;
+  volatile uint8_t txMaxBurst_ = 0;
+  volatile uint32_t txBatches_ = 0;
+  volatile uint32_t txBatched_ = 0;
+  volatile uint32_t txRepeatTooBig_ = 0;  // Repeated frames sent once: too big for a slot
+  volatile uint32_t txRepeatNoSlot_ = 0;  // Repeated frames sent once: every slot busy
+
+  // Receive pool.  rxReady_ carries buffer indices from the net task (only
+  // producer) to the dispatcher (only consumer).
+  RxPacket rxPool_[RX_POOL_SIZE];
+  uint8_t rxRefs_[RX_POOL_SIZE] = {};
+  uint32_t rxFree_ = (1u << RX_POOL_SIZE) - 1;
+  uint8_t rxInUse_ = 0;
+  uint8_t rxPeak_ = 0;
+  portMUX_TYPE poolMux_ = portMUX_INITIALIZER_UNLOCKED;
+  SpscRing<uint8_t, RX_POOL_SIZE> rxReady_;
+  TaskHandle_t volatile dispatcher_ = nullptr;
+  volatile uint32_t rxPackets_ = 0;
+  volatile uint32_t rxNoBuffer_ = 0;
+  volatile uint32_t rxMalformed_ = 0;
+  volatile uint32_t rxDuplicates_ = 0;
+  Proto::DupFilter rxDups_;             // Net task only
+
   // State
   volatile bool listening_ = false;
   volatile uint32_t lastRxMs_ = 0;
@@ -0,0 +1,84 @@
+// NodeProfile.h
+#pragma once
+#include <Arduino.h>
+
+//
+// Per-node capability profile.
+//
+// Each arch can be fitted with a different mix of hardware.  The profile is
+// stored in the persistent settings (see SettingsStore) and decides which
+// tasks are started at boot and which shows the node takes part in.
+//
+
+// Proximity sensor fitted to this node.
+enum class ProxType : uint8_t {
+  NONE  = 0,  // No sensor, never triggers locally
+  LIDAR = 1,  // TOFSense-F2 Mini Lidar on I2C
+  PIR   = 2,  // AM312 PIR switch on the I2C SDA pin
+  COUNT       // Must be last
+};
+
+// Motor outputs fitted to this node.
+enum class MotorType : uint8_t {
+  NONE     = 0,  // No motor task
+  SERVO    = 1,  // PWM hobby servo on SERVO_1_PIN
+  DISCRETE = 2,  // ON/OFF motor on SERVO_2_PIN
+  BOTH     = 3,  // Servo and discrete motor
+  COUNT          // Must be last
+};
+
+// Addressable LED strip fitted to this node.
+enum class StripModel : uint8_t {
+  NONE                     = 0,  // No light task
+  XNBADA_WS2812_12V_5M     = 1,  // 250 LED WS2812B
+  ALITOVE_WS2815_12V_5M    = 2,  // 300 LED WS2815
+  COUNT                          // Must be last
+};
+
+// Show participation bits.
+static constexpr uint8_t SHOW_MASK_IDLE   = 0x01;  // Plays the idle loop
+static constexpr uint8_t SHOW_MASK_LOCAL  = 0x02;  // Plays the local trigger show
+static constexpr uint8_t SHOW_MASK_REMOTE = 0x04;  // Plays the peer trigger show
+static constexpr uint8_t SHOW_MASK_ALL    = SHOW_MASK_IDLE | SHOW_MASK_LOCAL | SHOW_MASK_REMOTE;
+
+// ---- Build-time hardware defaults ----
+//
+// Uncomment only ONE of the following light strip models in use.  The LED
+// driver is compiled for this strip; the profile can only enable/disable it.
+//#define ALITOVE_WS2815_12V_5M_STRIP
+#define XNBADA_WS2812_12V_5M_STRIP
+
+#if defined(ALITOVE_WS2815_12V_5M_STRIP)
+static constexpr StripModel STRIP_MODEL_BUILD = StripModel::ALITOVE_WS2815_12V_5M;
+#else
+static constexpr StripModel STRIP_MODEL_BUILD = StripModel::XNBADA_WS2812_12V_5M;
+#endif
+
+// Sensor assumed by nodes that have never had a profile saved.
+// Set with -DPROX_TYPE_LIDAR or -DPROX_TYPE_PIR in platformio.ini.
+#if defined(PROX_TYPE_LIDAR)
+static constexpr ProxType PROX_TYPE_BUILD = ProxType::LIDAR;
+#elif defined(PROX_TYPE_PIR)
+static constexpr ProxType PROX_TYPE_BUILD = ProxType::PIR;
+#else
+static constexpr ProxType PROX_TYPE_BUILD = ProxType::NONE;
+#endif
+
+struct NodeProfile {
+  ProxType   proxType;
+  MotorType  motorType;
+  StripModel stripModel;
+  uint8_t    showMask;
+
+  bool hasProx()   const { return proxType != ProxType::NONE; }
+  bool hasMotor()  const { return motorType != MotorType::NONE; }
+  bool hasServo()  const { return motorType == MotorType::SERVO || motorType == MotorType::BOTH; }
+  bool hasDiscrete() const { return motorType == MotorType::DISCRETE || motorType == MotorType::BOTH; }
+  bool hasLights() const { return stripModel != StripModel::NONE; }
+  bool playsShow(uint8_t bit) const { return (showMask & bit) != 0; }
+};
+
+// Names used by the console, indexed by the enum value.
+static const char* const PROX_TYPE_NAMES[]   = { "none", "lidar", "pir" };
+static const char* const MOTOR_TYPE_NAMES[]  = { "none", "servo", "discrete", "both" };
+static const char* const STRIP_MODEL_NAMES[] = { "none", "ws2812", "ws2815" };
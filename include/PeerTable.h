@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+#include "Protocol.h"
+
+//
+// PeerTable keeps a live view of every node we hear.
+//
+// Every frame from a peer updates its last-seen time and link statistics;
+// pings add the RSSI and prox range the peer reports.  Link quality comes
+// from the v2 header:
+// - Loss is counted from gaps in the sender's sequence numbers.  A jump
+//   backwards (or too far forwards) is taken as a reboot and restarts the
+//   count.
+// - Jitter is the RFC 3550 inter-arrival jitter: the change in transit time
+//   (arrival - sentMs) between consecutive frames, smoothed by 1/16.
+// v1 frames only update last-seen, RSSI and range.
+//
+// The dispatcher task is the only writer.  Each entry is guarded by a
+// sequence counter (seqlock) so any task can take a consistent copy without
+// locks or blocking the writer.
+//
+
+// Node ids 0..PEER_MAX_NODES-1 are tracked; higher ids are ignored.
+static constexpr uint8_t PEER_MAX_NODES = 32;
+
+// A peer not heard from for this long is shown as gone.
+static constexpr uint32_t PEER_ALIVE_MS = 5000;
+
+struct PeerInfo {
+  uint32_t lastSeenMs = 0;   // Local millis() of the last frame, 0 = never
+  uint32_t received = 0;     // Frames received since the last restart
+  uint32_t lost = 0;         // Frames missing from the sequence since then
+  uint32_t restarts = 0;     // Sequence restarts (reboots) seen
+  uint16_t lossQ16 = 0;      // Smoothed loss fraction, 65535 = all lost
+  uint16_t jitterMsX16 = 0;  // Smoothed jitter in 1/16 ms
+  uint16_t rangeMm = 0;      // Proximity range in mm, from the last ping
+  int8_t   rssi = 0;         // From the last ping, the peer's own link
+  uint8_t  version = 0;      // Protocol version of the last frame
+};
+
+// Writer side (dispatcher task only).
+void peer_table_heard(const Proto::Header& hdr, uint32_t rxLocalMs);
+void peer_table_ping(uint8_t id, int8_t rssi, uint16_t rangeMm);
+
+// Consistent copy of one entry.  False if the id is untracked or never heard.
+bool peer_table_get(uint8_t id, PeerInfo& out);
+
+// Peers heard within PEER_ALIVE_MS.
+uint8_t peer_table_alive();
+
+// Print the table to the console.
+void peer_table_print();
@@ -1,17 +1,30 @@
 // Protocol.h
 #pragma once
 #include <Arduino.h>
+#include <array>
 #include <stdint.h>
 #include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus < 201703L
+#error "Protocol.h needs C++17 (build_unflags/build_flags in platformio.ini)"
+#endif
 
 namespace Proto {
 
 // ---- Constants ----
-static constexpr uint8_t  MAGIC       = 0xA5;
+// v1 frames start with MAGIC and carry a 4 byte header.  v2 frames start
+// with MAGIC_V2 and add a sequence number and the sender's fleet time at
+// transmit.  Nodes send v2 and accept both.
+static constexpr uint8_t  MAGIC       = 0xA5;     // v1
+static constexpr uint8_t  MAGIC_V2    = 0xA6;
 static constexpr uint8_t  BROADCAST   = 0xFF;     // 255 = all nodes
 static constexpr uint8_t  MIN_NODE_ID = 0x00;
 static constexpr uint8_t  MAX_NODE_ID = 0xFE;     // 0..254
-static constexpr size_t   HDR_SIZE    = 4;
+static constexpr size_t   HDR_V1_SIZE = 4;
+static constexpr size_t   HDR_SIZE    = 10;       // v2, what we send
 static constexpr size_t   MAX_FRAME   = 256;      // tune as needed
 
 // ---- Command codes (grow this as you add more) ----
@@ -19,15 +32,22 @@ enum Command : uint8_t {
   CMD_PING          = 0x00,
   CMD_CHANGE_MODE   = 0x01,
   CMD_TRIGGER_ANIM  = 0x02,
+  CMD_TIME_REQ      = 0x03,
+  CMD_TIME_RESP     = 0x04,
+  CMD_BATCH         = 0x05,
 };
 
-// ---- On-the-wire header (4 bytes) ----
+// ---- On-the-wire header (4 bytes v1, 10 bytes v2) ----
 // We don't rely on struct packing on the wire; we explicitly write/read bytes.
+// v2 adds seq (little endian u16) and sentMs (u32) after cmd.
 struct Header {
-  uint8_t magic;   // always 0xA5
-  uint8_t dst;     // 0..254, or 255 for broadcast
-  uint8_t src;     // 0..254
-  uint8_t cmd;     // Command code
+  uint8_t  magic;    // 0xA5 (v1) or 0xA6 (v2)
+  uint8_t  dst;      // 0..254, or 255 for broadcast
+  uint8_t  src;      // 0..254
+  uint8_t  cmd;      // Command code
+  uint16_t seq;      // v2: per-sender message number, same on redundant copies
+  uint32_t sentMs;   // v2: sender fleet time at transmit
+  uint8_t  version;  // 1 or 2, from the magic (not on the wire)
 };
 
 // ---- Parsed view of a received frame ----
@@ -43,73 +63,474 @@ inline bool isForMe(uint8_t myId, uint8_t dst) {
   return dst == myId || dst == BROADCAST;
 }
 
-// Encode just the 4B header into out[], returns bytes written (4) or 0 on error
+// Little-endian field helpers
+inline void putU16(uint8_t* out, uint16_t v) {
+  out[0] = (uint8_t)(v & 0xFF);
+  out[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+inline uint16_t getU16(const uint8_t* in) {
+  return (uint16_t)(in[0] | (in[1] << 8));
+}
+inline void putU32(uint8_t* out, uint32_t v) {
+  out[0] = (uint8_t)(v & 0xFF);
+  out[1] = (uint8_t)((v >> 8) & 0xFF);
+  out[2] = (uint8_t)((v >> 16) & 0xFF);
+  out[3] = (uint8_t)((v >> 24) & 0xFF);
+}
+inline uint32_t getU32(const uint8_t* in) {
+  return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+         ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+inline void putU64(uint8_t* out, uint64_t v) {
+  putU32(out, (uint32_t)v);
+  putU32(out + 4, (uint32_t)(v >> 32));
+}
+inline uint64_t getU64(const uint8_t* in) {
+  return (uint64_t)getU32(in) | ((uint64_t)getU32(in + 4) << 32);
+}
+
+// Encode the v2 header into out[], returns bytes written (10) or 0 on error.
+// seq and sentMs are left 0 for stampHeader() at transmit time.
 inline size_t encodeHeader(uint8_t* out, size_t cap,
                            uint8_t dst, uint8_t src, uint8_t cmd) {
   if (!out || cap < HDR_SIZE) return 0;
-  out[0] = MAGIC;
+  out[0] = MAGIC_V2;
   out[1] = dst;
   out[2] = src;
   out[3] = cmd;
+  putU16(&out[4], 0);
+  putU32(&out[6], 0);
   return HDR_SIZE;
 }
 
-// ---- Command-specific encoders (examples) ----
-// 0x00 Ping: no payload
-inline size_t buildPing(uint8_t* out, size_t cap, uint8_t dst, uint8_t src,
-                        int8_t rssi, uint16_t range) {
-  if (cap < HDR_SIZE + 3) return 0;
-  size_t n = encodeHeader(out, cap, dst, src, CMD_PING);
-  out[n++] = rssi;
-  out[n++] = (uint8_t)(range & 0xff);
-  out[n++] = (uint8_t)((range >> 8) & 0xFF);
-  return n;
+// Fill in the v2 sequence number and send time of an encoded frame.
+inline void stampHeader(uint8_t* frame, uint16_t seq, uint32_t sentMs) {
+  putU16(&frame[4], seq);
+  putU32(&frame[6], sentMs);
 }
+inline void stampSeq(uint8_t* frame, uint16_t seq) {
+  putU16(&frame[4], seq);
+}
+
+// ---- Message schema ----
+// Each command's payload is declared once, as a struct: its code, its
+// fields in wire order, and fields() naming them.  encode(), decode(), has()
+// and the Dispatcher are generated from that at compile time; nothing is
+// looked up at run time.  Fields are little endian integers packed back to
+// back.
+//
+// Fields are only ever appended, so a shorter payload comes from an older
+// sender.  A frame must carry the first MIN_FIELDS; missing fields after
+// that decode as 0, and has() tells which were present.
+//
+// To add a command: give it a code in Command, declare its struct below
+// and add it to Messages.
+
+template <typename T>
+inline void putField(uint8_t* p, T v) {
+  using U = typename std::make_unsigned<T>::type;
+  const U u = (U)v;
+  if constexpr (sizeof(T) == 1) *p = (uint8_t)u;
+  else if constexpr (sizeof(T) == 2) putU16(p, u);
+  else if constexpr (sizeof(T) == 4) putU32(p, u);
+  else putU64(p, u);
+}
+template <typename T>
+inline T getField(const uint8_t* p) {
+  if constexpr (sizeof(T) == 1) return (T)*p;
+  else if constexpr (sizeof(T) == 2) return (T)getU16(p);
+  else if constexpr (sizeof(T) == 4) return (T)getU32(p);
+  else return (T)getU64(p);
+}
+
+template <typename M, typename T>
+constexpr size_t fieldSize(T M::*) {
+  static_assert(std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 ||
+                sizeof(T) == 4 || sizeof(T) == 8), "Schema fields must be 8 to 64 bit integers");
+  return sizeof(T);
+}
+template <typename M, typename T>
+constexpr bool sameField(T M::* a, T M::* b) { return a == b; }
+template <typename M, typename A, typename B>
+constexpr bool sameField(A M::*, B M::*) { return false; }
+
+template <typename M>
+struct Schema {
+  static constexpr size_t FIELDS = std::tuple_size<decltype(M::fields())>::value;
+
+  // Wire bytes of the first n fields.
+  static constexpr size_t bytes(size_t n) {
+    size_t total = 0, i = 0;
+    std::apply([&](auto... f) { ((total += (i++ < n) ? fieldSize(f) : 0), ...); }, M::fields());
+    return total;
+  }
+
+  // Payload bytes up to and including field f.
+  template <typename T>
+  static constexpr size_t end(T M::* f) {
+    size_t off = 0, at = 0;
+    std::apply([&](auto... g) { ((off += fieldSize(g), at = (!at && sameField(g, f)) ? off : at), ...); },
+               M::fields());
+    return at;
+  }
+
+  static constexpr size_t PAYLOAD = bytes(FIELDS);
+  static constexpr size_t MIN_PAYLOAD = bytes(M::MIN_FIELDS);
+  static_assert(M::MIN_FIELDS >= 1 && M::MIN_FIELDS <= FIELDS, "MIN_FIELDS out of range");
+  static_assert(HDR_SIZE + PAYLOAD <= MAX_FRAME, "Message does not fit in a frame");
+};
+
+// 0x00 Ping: link and health report, also the fleet clock beacon
+struct PingMsg {
+  static constexpr Command CMD = CMD_PING;
+  static constexpr uint8_t MIN_FIELDS = 2;
+  int8_t   rssi = 0;
+  uint16_t rangeMm = 0;        // Proximity range, mm
+  uint32_t fleetMs = 0;        // Sender fleet time
+  uint16_t queueDrops = 0;     // Command queue health
+  uint8_t  queueFillPct = 0;
+  static constexpr auto fields() {
+    return std::make_tuple(&PingMsg::rssi, &PingMsg::rangeMm, &PingMsg::fleetMs,
+                           &PingMsg::queueDrops, &PingMsg::queueFillPct);
+  }
+};
+
+// 0x01 Change Mode
+struct ChangeModeMsg {
+  static constexpr Command CMD = CMD_CHANGE_MODE;
+  static constexpr uint8_t MIN_FIELDS = 1;
+  uint8_t mode = 0;
+  static constexpr auto fields() { return std::make_tuple(&ChangeModeMsg::mode); }
+};
+
+// 0x02 Trigger Animation
+struct TriggerAnimMsg {
+  static constexpr Command CMD = CMD_TRIGGER_ANIM;
+  static constexpr uint8_t MIN_FIELDS = 1;
+  uint8_t  animId = 0;
+  uint32_t startAtMs = 0;      // Fleet start time, 0 = start now
+  uint16_t waveStepMs = 0;     // Per-position delay for wave triggers, 0 = all at once
+  static constexpr auto fields() {
+    return std::make_tuple(&TriggerAnimMsg::animId, &TriggerAnimMsg::startAtMs,
+                           &TriggerAnimMsg::waveStepMs);
+  }
+};
+
+// 0x03 Time Request (see FleetClock.h)
+struct TimeReqMsg {
+  static constexpr Command CMD = CMD_TIME_REQ;
+  static constexpr uint8_t MIN_FIELDS = 1;
+  uint64_t t1 = 0;             // Requester's clock at transmit (us)
+  static constexpr auto fields() { return std::make_tuple(&TimeReqMsg::t1); }
+};
+
+// 0x04 Time Response
+struct TimeRespMsg {
+  static constexpr Command CMD = CMD_TIME_RESP;
+  static constexpr uint8_t MIN_FIELDS = 3;
+  uint64_t t1 = 0;             // Echoed from the request
+  uint64_t t2 = 0;             // Responder fleet time when the request arrived (us)
+  uint64_t t3 = 0;             // Responder fleet time at transmit (us)
+  static constexpr auto fields() {
+    return std::make_tuple(&TimeRespMsg::t1, &TimeRespMsg::t2, &TimeRespMsg::t3);
+  }
+};
+
+template <typename... M> struct MessageList {};
+
+// Every command with a schema.  Batches are a container, not a message.
+using Messages = MessageList<PingMsg, ChangeModeMsg, TriggerAnimMsg, TimeReqMsg, TimeRespMsg>;
+
+// Field I of M, and where it sits in the payload.
+template <typename M, size_t I>
+using FieldType = typename std::remove_reference<
+    decltype(std::declval<M&>().*std::get<I>(M::fields()))>::type;
+
+// Payload bytes of the first N fields of M, as a compile time constant.
+template <typename M, size_t N>
+constexpr size_t fieldsEnd = Schema<M>::bytes(N);
 
-// 0x01 Change Mode: payload[0] = mode
-inline size_t buildChangeMode(uint8_t* out, size_t cap, uint8_t dst, uint8_t src,
-                              uint8_t mode) {
-  if (cap < HDR_SIZE + 1) return 0;
-  size_t n = encodeHeader(out, cap, dst, src, CMD_CHANGE_MODE);
-  out[n++] = mode;
-  return n;
+template <typename M, size_t... I>
+inline void encodeFields(uint8_t* p, const M& msg, std::index_sequence<I...>) {
+  (putField(p + fieldsEnd<M, I>, msg.*std::get<I>(M::fields())), ...);
 }
 
-// 0x02 Trigger Animation: payload[0] = animId
-inline size_t buildTriggerAnim(uint8_t* out, size_t cap, uint8_t dst, uint8_t src,
-                               uint8_t animId) {
-  if (cap < HDR_SIZE + 1) return 0;
-  size_t n = encodeHeader(out, cap, dst, src, CMD_TRIGGER_ANIM);
-  out[n++] = animId;
-  return n;
+// ALL: the payload is known to hold every field, so nothing is checked.
+template <bool ALL, typename M, size_t... I>
+inline void decodeFields(const uint8_t* p, size_t len, M& msg, std::index_sequence<I...>) {
+  ((msg.*std::get<I>(M::fields()) = (ALL || len >= fieldsEnd<M, I + 1>)
+        ? getField<FieldType<M, I>>(p + fieldsEnd<M, I>) : FieldType<M, I>()), ...);
+}
+
+template <typename M, size_t... I>
+inline uint8_t fieldsPresent(size_t len, std::index_sequence<I...>) {
+  return (uint8_t)((len >= fieldsEnd<M, I + 1>) + ...);
+}
+
+// Encode msg as a complete v2 frame.  Returns the frame length, or 0 if
+// cap is too small.
+template <typename M>
+inline size_t encode(uint8_t* out, size_t cap, uint8_t dst, uint8_t src, const M& msg) {
+  constexpr size_t len = HDR_SIZE + Schema<M>::PAYLOAD;
+  if (!out || cap < len) return 0;
+  encodeFields(out + encodeHeader(out, cap, dst, src, M::CMD), msg,
+               std::make_index_sequence<Schema<M>::FIELDS>());
+  return len;
+}
+
+// Decode a frame into msg.  Returns the number of fields present, or 0 if
+// the frame is another command or too short.
+template <typename M>
+inline uint8_t decode(const View& v, M& msg) {
+  if (v.hdr.cmd != M::CMD || v.payload_len < Schema<M>::MIN_PAYLOAD) return 0;
+  constexpr auto all = std::make_index_sequence<Schema<M>::FIELDS>();
+  if (v.payload_len >= Schema<M>::PAYLOAD) {
+    // Current senders, the common case.
+    decodeFields<true>(v.payload, v.payload_len, msg, all);
+    return (uint8_t)Schema<M>::FIELDS;
+  }
+  decodeFields<false>(v.payload, v.payload_len, msg, all);
+  return fieldsPresent<M>(v.payload_len, all);
+}
+
+// True if a frame of message M carried field f (older senders stop short).
+template <typename M, typename T>
+inline bool has(const View& v, T M::* f) {
+  return v.hdr.cmd == M::CMD && v.payload_len >= Schema<M>::end(f);
+}
+
+// ---- Batches ----
+// 0x05 Batch: several commands in one datagram.  The payload is a list of
+// records, each
+//   [0] = cmd, [1] = dst, [2] = payload length n, [3..3+n) = that command's payload
+// laid out exactly as in its own frame.  The batch header's src, seq and
+// sentMs cover every record; its dst is BROADCAST and each record names its
+// own.  Batches do not nest.
+static constexpr size_t BATCH_RECORD_HDR = 3;
+
+// Packs single-command v2 frames (from encode()) into a batch.
+class BatchWriter {
+public:
+  BatchWriter(uint8_t* out, size_t cap, uint8_t src)
+    : out_(out), cap_(cap), len_(encodeHeader(out, cap, BROADCAST, src, CMD_BATCH)) {}
+
+  // Append the command in frame[0..len).  False if it does not fit or is
+  // not a v2 single-command frame; the batch is unchanged.
+  bool add(const uint8_t* frame, size_t len) {
+    if (!len_ || len < HDR_SIZE || frame[0] != MAGIC_V2 || frame[3] == CMD_BATCH) return false;
+    const size_t n = len - HDR_SIZE;
+    if (n > 0xFF || len_ + BATCH_RECORD_HDR + n > cap_) return false;
+    out_[len_++] = frame[3];
+    out_[len_++] = frame[1];
+    out_[len_++] = (uint8_t)n;
+    memcpy(&out_[len_], &frame[HDR_SIZE], n);
+    len_ += n;
+    count_++;
+    return true;
+  }
+
+  uint8_t count() const { return count_; }
+  size_t  size() const { return len_; }     // Frame length so far
+
+private:
+  uint8_t* out_;
+  size_t   cap_;
+  size_t   len_;
+  uint8_t  count_ = 0;
+};
+
+// True if a batch payload is a whole number of well formed records.
+inline bool batchValid(const uint8_t* p, size_t n) {
+  if (n == 0) return false;
+  while (n) {
+    if (n < BATCH_RECORD_HDR || p[0] == CMD_BATCH || BATCH_RECORD_HDR + p[2] > n) return false;
+    const size_t rec = BATCH_RECORD_HDR + p[2];
+    p += rec;
+    n -= rec;
+  }
+  return true;
+}
+
+// Call fn(const View&) for each command in a parsed frame, in order: once
+// for a plain frame, once per record for a batch.  Each record's View has
+// the batch header with the record's cmd and dst, and its payload points
+// into the frame, so nothing is copied.  Returns the number of commands.
+template <typename Fn>
+inline size_t forEachCommand(const View& v, Fn&& fn) {
+  if (v.hdr.cmd != CMD_BATCH) {
+    fn(v);
+    return 1;
+  }
+  View rec;
+  rec.hdr = v.hdr;
+  const uint8_t* p = v.payload;
+  size_t left = v.payload_len;
+  size_t count = 0;
+  while (left >= BATCH_RECORD_HDR) {   // parse() checked the layout
+    const size_t n = p[2];
+    rec.hdr.cmd = p[0];
+    rec.hdr.dst = p[1];
+    rec.payload = n ? p + BATCH_RECORD_HDR : nullptr;
+    rec.payload_len = n;
+    fn(rec);
+    count++;
+    p += BATCH_RECORD_HDR + n;
+    left -= BATCH_RECORD_HDR + n;
+  }
+  return count;
 }
 
 // ---- Parser ----
 // Returns true on success; fills View with header + payload view.
-// Validates magic and minimum length.
+// Validates magic, minimum length and the sender id (broadcast is not a
+// sender).  Accepts v1 and v2 frames; v1 frames decode with seq and sentMs
+// 0.  A batch must hold whole records.
 inline bool parse(const uint8_t* buf, size_t len, View& out) {
-  if (!buf || len < HDR_SIZE) return false;
-  if (buf[0] != MAGIC) return false;
+  if (!buf || len < HDR_V1_SIZE) return false;
+
+  size_t hdrLen;
+  if (buf[0] == MAGIC_V2) {
+    if (len < HDR_SIZE) return false;
+    hdrLen = HDR_SIZE;
+    out.hdr.version = 2;
+    out.hdr.seq     = getU16(&buf[4]);
+    out.hdr.sentMs  = getU32(&buf[6]);
+  } else if (buf[0] == MAGIC) {
+    hdrLen = HDR_V1_SIZE;
+    out.hdr.version = 1;
+    out.hdr.seq     = 0;
+    out.hdr.sentMs  = 0;
+  } else {
+    return false;
+  }
 
   out.hdr.magic = buf[0];
   out.hdr.dst   = buf[1];
   out.hdr.src   = buf[2];
   out.hdr.cmd   = buf[3];
-  out.payload   = (len > HDR_SIZE) ? (buf + HDR_SIZE) : nullptr;
-  out.payload_len = (len > HDR_SIZE) ? (len - HDR_SIZE) : 0;
+  if (out.hdr.src > MAX_NODE_ID) return false;
+  out.payload   = (len > hdrLen) ? (buf + hdrLen) : nullptr;
+  out.payload_len = (len > hdrLen) ? (len - hdrLen) : 0;
+  if (out.hdr.cmd == CMD_BATCH) return batchValid(out.payload, out.payload_len);
   return true;
 }
 
-// ---- Tiny payload decoders (optional convenience) ----
-inline bool decodeChangeMode(const View& v, uint8_t& modeOut) {
-  if (v.hdr.cmd != CMD_CHANGE_MODE || v.payload_len < 1) return false;
-  modeOut = v.payload[0];
+// ---- Duplicate suppression ----
+// Per-sender sliding window over v2 sequence numbers.  Remembers the
+// newest seq from each node, its sentMs, and which of the DUP_WINDOW before
+// it were seen, so redundant copies and network duplicates are dropped.
+// v1 frames have no seq and always pass.
+//
+// The sender's window restarts (it rebooted and its seq began again at 0)
+// when the seq is further than the window from the newest, or when the seq
+// has not moved ahead yet sentMs is more than DUP_RESTART_MS away from the
+// newest's, either way.  A time jump alone is not a restart: a FleetClock
+// step moves sentMs while the seq keeps counting up, so the window is kept,
+// and the sender's time from before the step is remembered so late copies
+// stamped before it still match.  Copies are byte-identical and reordered
+// frames are sent within a few ms of each other, so neither looks like a
+// restart; a reboot takes seconds.
+static constexpr uint16_t DUP_WINDOW = 16;
+static constexpr uint32_t DUP_RESTART_MS = 1000;
+
+class DupFilter {
+public:
+  // True the first time (src, seq) is seen.  parse() has checked src.
+  bool accept(const Header& h) {
+    if (h.version < 2) return true;
+    Peer& p = peers_[h.src];
+    const int16_t ahead = (int16_t)(h.seq - p.newest);
+    const bool jumped = far(h.sentMs, p.newestMs) && far(h.sentMs, p.beforeStepMs);
+    if (p.seen == 0 || ahead >= (int16_t)DUP_WINDOW || ahead <= -(int16_t)DUP_WINDOW ||
+        (ahead <= 0 && jumped)) {
+      p.newest = h.seq;
+      p.newestMs = h.sentMs;
+      p.beforeStepMs = h.sentMs;
+      p.seen = 1;
+      return true;
+    }
+    if (ahead > 0) {
+      if (far(h.sentMs, p.newestMs)) p.beforeStepMs = p.newestMs;
+      p.seen = (uint16_t)((p.seen << ahead) | 1u);
+      p.newest = h.seq;
+      p.newestMs = h.sentMs;
+      return true;
+    }
+    const uint16_t bit = (uint16_t)(1u << -ahead);
+    if (p.seen & bit) return false;
+    p.seen |= bit;
+    return true;
+  }
+
+private:
+  struct Peer {
+    uint16_t newest;
+    uint16_t seen;          // bit n = newest - n seen, 0 = nothing from this node yet
+    uint32_t newestMs;      // sentMs of newest
+    uint32_t beforeStepMs;  // sentMs of the newest before the last clock step
+  };
+
+  static bool far(uint32_t a, uint32_t b) {
+    const int32_t d = (int32_t)(a - b);
+    return d > (int32_t)DUP_RESTART_MS || d < -(int32_t)DUP_RESTART_MS;
+  }
+  Peer peers_[MAX_NODE_ID + 1] = {};
+};
+
+// ---- Dispatch ----
+// A 256 entry table, built at compile time from Messages, maps each command
+// code straight to a stub that decodes the payload into its struct and
+// calls Handler::on(msg, view, ctx), so dispatch is one load and one call
+// however many messages there are.  Handler must have an on() for every
+// message, so a new command cannot be left unhandled by accident.
+template <typename Handler, typename Ctx, typename Msg>
+inline bool dispatchStub(const View& v, Ctx& ctx) {
+  Msg msg;
+  if (!decode(v, msg)) return false;
+  Handler::on(msg, v, ctx);
   return true;
 }
-inline bool decodeTriggerAnim(const View& v, uint8_t& animIdOut) {
-  if (v.hdr.cmd != CMD_TRIGGER_ANIM || v.payload_len < 1) return false;
-  animIdOut = v.payload[0];
+
+template <typename... M>
+constexpr bool uniqueCommands() {
+  const uint8_t cmds[] = {M::CMD...};
+  for (size_t i = 0; i < sizeof...(M); i++)
+    for (size_t j = i + 1; j < sizeof...(M); j++)
+      if (cmds[i] == cmds[j]) return false;
   return true;
 }
 
+template <typename Handler, typename Ctx, typename List = Messages>
+class Dispatcher;
+
+template <typename Handler, typename Ctx, typename... M>
+class Dispatcher<Handler, Ctx, MessageList<M...>> {
+public:
+  typedef bool (*Stub)(const View& v, Ctx& ctx);
+
+  // Decode v and hand it to its handler.  False if the command has no
+  // schema or its payload is too short.
+  static bool dispatch(const View& v, Ctx& ctx) {
+    const Stub stub = TABLE[v.hdr.cmd];
+    return stub && stub(v, ctx);
+  }
+
+  static bool known(uint8_t cmd) { return TABLE[cmd] != nullptr; }
+
+private:
+  static_assert(uniqueCommands<M...>(), "Two messages share a command code");
+
+  static constexpr std::array<Stub, 256> table() {
+    std::array<Stub, 256> t{};
+    ((t[M::CMD] = &dispatchStub<Handler, Ctx, M>), ...);
+    return t;
+  }
+  static constexpr std::array<Stub, 256> TABLE = table();
+};
+
 } // namespace Proto
+
+// Time x rounds of encode, and parse plus dispatch, over one frame of each
+// message and print the cost in cycles/msg.
+void proto_benchmark(uint32_t iterations);
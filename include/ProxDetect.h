@@ -1,13 +1,12 @@
 #pragma once
 #include <Arduino.h>
+#include "NodeProfile.h"
 
 
-// Starts the proximity detector task.
+// Starts the proximity detector task for the given sensor type.
 //
-// Returns: true on success, false on failure.
-bool prox_detect_start(UBaseType_t priority = 2,
-                uint32_t stack_bytes = 4096,
-                BaseType_t core = 1);
+// Returns: true on success, false on failure (or no sensor).
+bool prox_detect_start(ProxType type);
 
 // Return the latest range reading
 float prox_range();
\ No newline at end of file
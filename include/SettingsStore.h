@@ -4,6 +4,7 @@
 #include <Preferences.h>
 #include <stdint.h>
 #include <string.h>
+#include "NodeProfile.h"
 
 namespace Persist {
 
@@ -17,6 +18,13 @@ public:
   static constexpr size_t kMaxSsid = 32;
   static constexpr size_t kMaxPwd  = 64;
 
+  // Wave position table covers node ids 0..kMaxWaveNodes-1.
+  static constexpr size_t kMaxWaveNodes = 16;
+
+  // How the station gets its address.  Lease reuses the last DHCP lease as
+  // a static address (the router must reserve it), so a rejoin skips DHCP.
+  enum class IpMode : uint8_t { Dhcp = 0, Lease, Static, COUNT };
+
   // On-flash blob (explicit size; CRC covers all fields except crc)
   struct __attribute__((packed)) Blob {
     uint32_t magic;           // kMagic
@@ -26,7 +34,25 @@ public:
     char     ssid[kMaxSsid];  // null-terminated
     char     pwd[kMaxPwd];    // null-terminated
     uint8_t  volume;          // 0-30
-    uint8_t  reserved[63];    // future use; must be zeroed
+    uint8_t  profileSet;      // 1 once a node profile was saved, 0 = legacy
+    uint8_t  proxType;        // ProxType
+    uint8_t  motorType;       // MotorType
+    uint8_t  stripModel;      // StripModel
+    uint8_t  showMask;        // SHOW_MASK_* bits
+    uint8_t  wavePosSet;      // 1 once wavePos[] was configured, 0 = position is node id
+    uint8_t  wavePos[kMaxWaveNodes]; // walkway position of each node id
+    uint16_t waveStepMs;      // per-position delay of triggers we send, 0 = all at once
+    uint8_t  joinSet;         // 1 once a WiFi join was cached below
+    uint8_t  joinChannel;     // channel of the last good join
+    uint8_t  joinBssid[6];    // access point of the last good join
+    uint32_t leaseIp;         // address, gateway and mask of the last join,
+    uint32_t leaseGw;         //   network byte order (as IPAddress stores them)
+    uint32_t leaseMask;
+    uint8_t  ipMode;          // IpMode
+    uint32_t staticIp;        // used when ipMode is Static
+    uint32_t staticGw;
+    uint32_t staticMask;
+    uint8_t  reserved[6];     // future use; must be zeroed
     uint32_t crc32;           // CRC32 of [magic..reserved]
   };
 
@@ -88,6 +114,9 @@ public:
     // Preset the volume
     blob_.volume = 20;
 
+    // Node profile is left unset so it follows the legacy defaults until
+    // someone configures this node explicitly.
+
     // reserved[] already zero
     blob_.crc32   = crc32Of(blob_); // keep consistent even before save
   }
@@ -98,12 +127,121 @@ public:
   String  password() const { return String(blob_.pwd);  }
   uint8_t volume()   const { return blob_.volume; }
 
+  // Node capability profile.  Nodes that never had one saved get the
+  // historic layout: sensors on nodes 1, 5 and 6, everything else fitted.
+  NodeProfile profile() const {
+    NodeProfile p;
+    if (blob_.profileSet) {
+      p.proxType   = static_cast<ProxType>(blob_.proxType);
+      p.motorType  = static_cast<MotorType>(blob_.motorType);
+      p.stripModel = static_cast<StripModel>(blob_.stripModel);
+      p.showMask   = blob_.showMask;
+    } else {
+      const uint8_t id = blob_.deviceId;
+      p.proxType   = (id == 1 || id == 5 || id == 6) ? PROX_TYPE_BUILD : ProxType::NONE;
+      p.motorType  = MotorType::BOTH;
+      p.stripModel = STRIP_MODEL_BUILD;
+      p.showMask   = SHOW_MASK_ALL;
+    }
+    return p;
+  }
+
   void setDeviceId(uint8_t id) {
     if (id <= 0xFE) blob_.deviceId = id;   // 0..254
   }
   void setSsid(const String& s)  { copyCString(s, blob_.ssid, sizeof(blob_.ssid)); }
   void setPassword(const String& p) { copyCString(p, blob_.pwd, sizeof(blob_.pwd)); }
 
+  // Position of a node along the walkway, used to delay wave triggers.
+  // Until a table is configured, nodes are ordered by id.
+  uint8_t wavePosition(uint8_t id) const {
+    if (blob_.wavePosSet && id < kMaxWaveNodes) return blob_.wavePos[id];
+    return id;
+  }
+  uint16_t waveStepMs() const { return blob_.waveStepMs; }
+
+  void setWavePosition(uint8_t id, uint8_t pos) {
+    if (id >= kMaxWaveNodes) return;
+    if (!blob_.wavePosSet) {
+      // Seed the table with the default id order before the first edit.
+      for (size_t i = 0; i < kMaxWaveNodes; i++) blob_.wavePos[i] = (uint8_t)i;
+      blob_.wavePosSet = 1;
+    }
+    blob_.wavePos[id] = pos;
+  }
+  void setWaveStepMs(uint16_t ms) { blob_.waveStepMs = ms; }
+
+  // Last good WiFi join, tried first on the next boot.  False if none.
+  bool wifiJoin(uint8_t bssid[6], uint8_t& channel,
+                uint32_t& ip, uint32_t& gw, uint32_t& mask) const {
+    if (!blob_.joinSet) return false;
+    memcpy(bssid, blob_.joinBssid, sizeof(blob_.joinBssid));
+    channel = blob_.joinChannel;
+    ip = blob_.leaseIp;
+    gw = blob_.leaseGw;
+    mask = blob_.leaseMask;
+    return true;
+  }
+
+  // Record a join.  Returns true if it differs from the cached one.
+  bool setWifiJoin(const uint8_t bssid[6], uint8_t channel,
+                   uint32_t ip, uint32_t gw, uint32_t mask) {
+    if (blob_.joinSet && blob_.joinChannel == channel &&
+        !memcmp(blob_.joinBssid, bssid, sizeof(blob_.joinBssid)) &&
+        blob_.leaseIp == ip && blob_.leaseGw == gw && blob_.leaseMask == mask) {
+      return false;
+    }
+    blob_.joinSet = 1;
+    blob_.joinChannel = channel;
+    memcpy(blob_.joinBssid, bssid, sizeof(blob_.joinBssid));
+    blob_.leaseIp = ip;
+    blob_.leaseGw = gw;
+    blob_.leaseMask = mask;
+    return true;
+  }
+
+  IpMode ipMode() const {
+    return blob_.ipMode < static_cast<uint8_t>(IpMode::COUNT) ? static_cast<IpMode>(blob_.ipMode)
+                                                              : IpMode::Dhcp;
+  }
+
+  // Address to configure before joining.  False for DHCP, or Lease with
+  // nothing cached yet.
+  bool staticIp(uint32_t& ip, uint32_t& gw, uint32_t& mask) const {
+    switch (ipMode()) {
+      case IpMode::Static:
+        ip = blob_.staticIp; gw = blob_.staticGw; mask = blob_.staticMask;
+        return ip != 0;
+      case IpMode::Lease:
+        ip = blob_.leaseIp; gw = blob_.leaseGw; mask = blob_.leaseMask;
+        return blob_.joinSet && ip != 0;
+      default:
+        return false;
+    }
+  }
+
+  void setIpMode(IpMode mode) {
+    if (mode < IpMode::COUNT) blob_.ipMode = static_cast<uint8_t>(mode);
+  }
+  void setStaticIp(uint32_t ip, uint32_t gw, uint32_t mask) {
+    blob_.ipMode = static_cast<uint8_t>(IpMode::Static);
+    blob_.staticIp = ip;
+    blob_.staticGw = gw;
+    blob_.staticMask = mask;
+  }
+
+  void setProfile(const NodeProfile& p) {
+    if (p.proxType >= ProxType::COUNT || p.motorType >= MotorType::COUNT ||
+        p.stripModel >= StripModel::COUNT) {
+      return;
+    }
+    blob_.profileSet = 1;
+    blob_.proxType   = static_cast<uint8_t>(p.proxType);
+    blob_.motorType  = static_cast<uint8_t>(p.motorType);
+    blob_.stripModel = static_cast<uint8_t>(p.stripModel);
+    blob_.showMask   = p.showMask & SHOW_MASK_ALL;
+  }
+
   void setVolume(uint8_t vol) {
     if (vol > 30) {
       blob_.volume = 30;
@@ -123,6 +261,10 @@ public:
   }
 
 private:
+  // Profile and WiFi join fields were carved out of reserved[]; the on-flash
+  // size must not move.
+  static_assert(sizeof(Blob) == 172, "SettingsStore::Blob layout changed size");
+
   // ---- Internals ----
   static void copyCString(const String& s, char* dst, size_t cap) {
     size_t n = min(s.length(), cap ? cap - 1 : 0);
@@ -9,6 +9,7 @@ enum ShowStates {
   SHOWSTATE_DISABLED,
   
   // Idle state animation loop
+  SHOWSTATE_WAIT_START,   // Waiting for a scheduled fleet start time
   SHOWSTATE_START_TABLE,
   SHOWSTATE_TABLE_STEP, 
   SHOWSTATE_STEP_WAIT
@@ -19,6 +20,4 @@ enum ShowStates {
 // Starts the main show task that drives all animated elements.
 //
 // Returns: true on success, false on failure.
-bool show_start(UBaseType_t priority = 2,
-                uint32_t stack_bytes = 4096,
-                BaseType_t core = 1);
\ No newline at end of file
+bool show_start();
\ No newline at end of file
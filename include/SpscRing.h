@@ -0,0 +1,79 @@
+// SpscRing.h — header-only lock-free single producer / single consumer ring
+//
+// Usage:
+//   static SpscRing<LightCmdQueueMsg, 8> ring;
+//   ring.push(msg);   // producer task only
+//   ring.pop(msg);    // consumer task only (peek() too)
+//
+// Notes:
+// - Exactly one task may push and exactly one task may pop.  Anyone else
+//   must use a regular FreeRTOS queue.
+// - Head and tail are free-running 32 bit counters; only the producer writes
+//   head_ and only the consumer writes tail_, so no critical section or
+//   read-modify-write atomics are needed (the C3 core has no atomic RMW).
+// - The ring does not block or wake anyone; pair it with a task notification.
+
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing
+{
+public:
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "Ring size must be a power of two");
+
+  // Producer side.  Returns false when full (the item is dropped).
+  inline bool push(const T& item)
+  {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= N)
+    {
+      return false;
+    }
+    buf_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.  Returns false when empty.
+  inline bool pop(T& item)
+  {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+      return false;
+    }
+    item = buf_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.  Copies the oldest item without removing it.
+  inline bool peek(T& item) const
+  {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+      return false;
+    }
+    item = buf_[tail & (N - 1)];
+    return true;
+  }
+
+  // Items waiting.  Exact from either side, a snapshot from anyone else.
+  inline size_t size() const
+  {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  inline bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  std::atomic<uint32_t> head_{0};  // next slot to write, producer owned
+  std::atomic<uint32_t> tail_{0};  // next slot to read, consumer owned
+  T buf_[N];
+};
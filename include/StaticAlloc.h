@@ -0,0 +1,120 @@
+// StaticAlloc.h
+#pragma once
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+//
+// Static allocation of every task and queue.
+//
+// Nothing the firmware starts at boot comes from the heap.  Task stacks and
+// TCBs live in one arena sized from TASK_TABLE, and each queue owns a
+// StaticQueue<> block next to the module that uses it.  The total is checked
+// against STATIC_RAM_BUDGET_BYTES at compile time (see StaticAlloc.cpp), and
+// the linker fails the build if the arena does not fit in DRAM, so running
+// out of memory is a build error rather than a boot fault in the field.
+//
+// The node profile (lights, motor, prox) is read from NVS at boot and can be
+// changed from the console without reflashing, so the light, motor and prox
+// slots are reserved whether or not the profile starts them: 3 x 4096 bytes
+// of stack plus a TCB each on a bare node.  Building with USE_FRAME_EXECUTOR
+// runs those jobs on FrameExec instead and their slots drop to zero.
+//
+
+#if defined(ESP32S3_BOARD)
+#define CORE_WORK 1
+#define CORE_WIFI 1
+#else
+#define CORE_WORK 0
+#define CORE_WIFI 0
+#endif
+
+#ifndef STATIC_RAM_BUDGET_BYTES
+#define STATIC_RAM_BUDGET_BYTES (72 * 1024)
+#endif
+
+// Every task the firmware can start, in TASK_TABLE order.
+enum class TaskId : uint8_t {
+  Net = 0,
+  NetDispatch,
+  Timer,
+  CommandExec,
+  Audio,
+  Light,
+  Motor,
+  ProxDetect,
+  Show,
+  OTA,
+  FrameExec,
+  COUNT        // Must be last
+};
+static constexpr size_t NUM_TASKS = static_cast<size_t>(TaskId::COUNT);
+
+struct TaskSpec {
+  const char* name;
+  uint32_t    stackBytes;
+  UBaseType_t priority;
+  BaseType_t  core;
+};
+
+static constexpr UBaseType_t TASK_PRIO_TOP = configMAX_PRIORITIES - 1;
+
+// The frame jobs (see FrameJob.h) get a task each, or all share FrameExec.
+#if defined(USE_FRAME_EXECUTOR)
+static constexpr uint32_t FRAME_TASK_STACK = 0;
+static constexpr uint32_t FRAME_EXEC_STACK = 8192;
+#else
+static constexpr uint32_t FRAME_TASK_STACK = 4096;
+static constexpr uint32_t FRAME_EXEC_STACK = 0;
+#endif
+
+// ---- Central task table ----
+// A zero stack means the task is not used in this build.
+static constexpr TaskSpec TASK_TABLE[NUM_TASKS] = {
+  { "net",            8192,                 5,             CORE_WIFI },  // Wifi needs larger stack
+  { "NetDispatch",    4096,                 4,             CORE_WIFI },  // Runs the packet callback
+  { "TimerSvc",       4096,                 3,             CORE_WORK },  // Also runs the console poll
+  { "CommandExec",    4096,                 2,             CORE_WORK },
+  { "AudioTask",      4096,                 TASK_PRIO_TOP, CORE_WORK },
+  { "LightTask",      FRAME_TASK_STACK,     TASK_PRIO_TOP, CORE_WORK },
+  { "MotorTask",      FRAME_TASK_STACK,     TASK_PRIO_TOP, CORE_WORK },
+  { "ProxDetectTask", FRAME_TASK_STACK,     TASK_PRIO_TOP, CORE_WORK },
+  { "ShowTask",       FRAME_TASK_STACK * 2, TASK_PRIO_TOP, CORE_WORK },
+  { "OTATask",        8192,                 TASK_PRIO_TOP, CORE_WORK },
+  { "FrameExec",      FRAME_EXEC_STACK,     TASK_PRIO_TOP, CORE_WORK },
+};
+
+// Stacks are carved from the arena on 16 byte boundaries (RISC-V ABI).
+static constexpr uint32_t STACK_ALIGN = 16;
+static constexpr uint32_t stack_slot_bytes(size_t i) {
+  return (TASK_TABLE[i].stackBytes + STACK_ALIGN - 1) & ~(STACK_ALIGN - 1);
+}
+static constexpr uint32_t stack_offset(size_t i) {
+  return i == 0 ? 0 : stack_offset(i - 1) + stack_slot_bytes(i - 1);
+}
+static constexpr uint32_t TASK_STACK_BYTES = stack_offset(NUM_TASKS);
+static constexpr uint32_t TASK_RAM_BYTES = TASK_STACK_BYTES + NUM_TASKS * sizeof(StaticTask_t);
+
+// Create task id from its table entry.  Returns nullptr if already running.
+TaskHandle_t static_task_create(TaskId id, TaskFunction_t fn, void* arg = nullptr);
+
+// Fixed storage for one FreeRTOS queue of LEN items of T.
+template <typename T, size_t LEN>
+class StaticQueue
+{
+public:
+  static constexpr size_t RAM_BYTES = sizeof(T) * LEN + sizeof(StaticQueue_t);
+
+  QueueHandle_t create()
+  {
+    return xQueueCreateStatic(LEN, sizeof(T), storage_, &queue_);
+  }
+
+private:
+  uint8_t       storage_[sizeof(T) * LEN];
+  StaticQueue_t queue_;
+};
+
+// Bytes reserved by all static allocations (tasks, queues, services).
+size_t static_ram_bytes();
@@ -0,0 +1,47 @@
+// StepParams.h
+#pragma once
+#include <Arduino.h>
+
+//
+// Effect parameters carried by a show step.
+//
+// Every field is optional.  Zero means "use the effect's own default", so a
+// value-initialized block leaves each animation looking as it always has.
+// Black is a valid color, so the colors only apply when STEP_PARAM_COLORS
+// is set in flags.
+//
+static constexpr uint8_t STEP_PARAM_COLORS = 0x01;
+
+struct StepParams {
+  uint8_t  flags;       // STEP_PARAM_* bits
+  uint8_t  colorA[3];   // Primary color R,G,B
+  uint8_t  colorB[3];   // Secondary color R,G,B
+  uint8_t  bandWidth;   // Pixels per color band
+  uint16_t speedMs;     // ms per motion step (light shift, motor dwell)
+  int8_t   direction;   // +1 or -1 motion direction
+  uint8_t  cooling;     // Flames cooling, 20..100 typical
+  uint8_t  sparking;    // Flames sparking, 50..200 typical
+  uint8_t  brightness;  // LED brightness for this step
+  uint8_t  volume;      // Audio volume for this step, 1..30
+  uint8_t  reserved;
+};
+static_assert(sizeof(StepParams) == 16, "StepParams must be 16 bytes");
+
+// Overlay the fields set in step onto base (the effect defaults).
+inline StepParams step_params_merge(const StepParams& base, const StepParams& step)
+{
+  StepParams out = base;
+  if (step.flags & STEP_PARAM_COLORS) {
+    out.flags |= STEP_PARAM_COLORS;
+    memcpy(out.colorA, step.colorA, sizeof(out.colorA));
+    memcpy(out.colorB, step.colorB, sizeof(out.colorB));
+  }
+  if (step.bandWidth)  out.bandWidth  = step.bandWidth;
+  if (step.speedMs)    out.speedMs    = step.speedMs;
+  if (step.direction)  out.direction  = step.direction;
+  if (step.cooling)    out.cooling    = step.cooling;
+  if (step.sparking)   out.sparking   = step.sparking;
+  if (step.brightness) out.brightness = step.brightness;
+  if (step.volume)     out.volume     = step.volume;
+  return out;
+}
@@ -0,0 +1,57 @@
+// TaskProfiler.h
+#pragma once
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+//
+// Lightweight per-task profiler.
+//
+// Every blocking wait in a task is bracketed by prof_wait_begin() and
+// prof_wait_end() (bus_wait() and the prof_delay helpers do this for you).
+// The time between waking and the next wait is that task's run burst; the
+// profiler keeps running totals of busy time, wakeups and the longest burst.
+// A task is registered the first time it waits, no setup call needed.
+//
+// prof_sample() is called about once a second by the timer service.  It copies the
+// counters into a fixed ring of samples, together with each task's stack
+// high-water mark and the heap levels, so the `cpu` command can report
+// averages over the last few seconds without any allocation.
+//
+// Notes:
+// - Busy time includes time lost to preemption by higher priority tasks, so
+//   it is an upper bound on the CPU the task actually used.
+// - Tasks that never block are not seen.  Idle time (below) shows them.
+//
+// Idle time comes from the FreeRTOS idle task's run-time counter when the
+// core is built with run-time stats.  A hook on the idle task also counts its
+// passes: the idle task runs once per tick it finds nothing to do, so a
+// falling rate means the idle task is starved (or tickless idle is sleeping).
+//
+static constexpr size_t   PROF_MAX_TASKS = 12;    // Tracked tasks
+static constexpr size_t   PROF_HISTORY   = 10;    // Samples kept
+static constexpr uint32_t PROF_SAMPLE_MS = 1000;  // Sample period
+
+// Wait bracketing.  Call from task context only.
+void prof_wait_begin();
+void prof_wait_end();
+
+inline void prof_delay(TickType_t ticks) {
+  prof_wait_begin();
+  vTaskDelay(ticks);
+  prof_wait_end();
+}
+inline void prof_delay_until(TickType_t* lastWake, TickType_t ticks) {
+  prof_wait_begin();
+  vTaskDelayUntil(lastWake, ticks);
+  prof_wait_end();
+}
+
+// Register the idle hook.  Call once from setup().
+bool prof_idle_start();
+
+// Take one sample of every tracked task.  Call every PROF_SAMPLE_MS.
+void prof_sample();
+
+// Print the per-task table averaged over the sample history.
+void prof_print();
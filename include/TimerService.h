@@ -0,0 +1,56 @@
+// TimerService.h
+#pragma once
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+//
+// Central timer service for periodic and one-shot housekeeping.
+//
+// Instead of each task polling on its own vTaskDelay(), subsystems register
+// a timer here.  When it expires, the timer either runs a callback on the
+// TimerSvc task or sets notification bits on a task.
+//
+// Every timer has a slack: it may fire anywhere from its due time up to due
+// + slack.  When the service wakes for one timer it also fires every other
+// timer that is already due, so timers with compatible slack share one
+// wakeup instead of waking the CPU separately.  Between deadlines the
+// service blocks, so nothing spins.
+//
+// Timers are kept in a three level hashed timing wheel (1 ms, 64 ms and
+// 4096 ms slots, 64 slots each) indexed by their latest fire time.  Insert
+// and cancel are O(1), and finding the next deadline is a bit scan.
+//
+// Callbacks must be short and must never block.  Blocking work belongs on
+// its own task, woken with timer_notify_every().
+//
+typedef void (*TimerFn)(void* arg);
+// Pool slot in the low byte and the slot's generation above it, so an id
+// left over from a timer that has fired or been cancelled never matches
+// the next timer given the same slot.
+typedef int16_t TimerId;                       // -1 = invalid
+
+static constexpr size_t TIMER_MAX = 16;         // Timer pool size
+
+// Run fn(arg) every periodMs, first after one period.
+TimerId timer_every(uint32_t periodMs, uint32_t slackMs, TimerFn fn, void* arg = nullptr);
+
+// Run fn(arg) once, delayMs from now.
+TimerId timer_once(uint32_t delayMs, uint32_t slackMs, TimerFn fn, void* arg = nullptr);
+
+// Set bits on task's notification value every periodMs.
+TimerId timer_notify_every(uint32_t periodMs, uint32_t slackMs, TaskHandle_t task, uint32_t bits);
+
+// Stop a timer.  Safe to call from its own callback, and a no-op for an id
+// whose timer has already fired (one-shot) or been cancelled.
+void timer_cancel(TimerId id);
+
+// Block the calling task until a timer (or anyone) notifies it.  Returns
+// the notification bits.
+uint32_t timer_wait(TickType_t ticks = portMAX_DELAY);
+
+// Start the TimerSvc task.  Timers may be added before or after.
+bool timer_service_start();
+
+// Print service wakeups and per-timer fire counts.
+void timer_print();
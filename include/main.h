@@ -1,6 +1,26 @@
+#pragma once
 #include <Arduino.h>
 #include "NetService.h"
 #include "SettingsStore.h"
 
 extern Persist::SettingsStore settingsConfig;
-extern NetService *networkService;
\ No newline at end of file
+extern NetService *networkService;
+
+// Receive counters by packet class.  Datagram counts come from NetService;
+// the command counts are per command, so a batch counts each it carries.
+struct RxClassStats
+{
+  uint32_t datagrams = 0;    // Read off the socket
+  uint32_t malformed = 0;    // Failed to parse, or oversize
+  uint32_t duplicates = 0;   // Redundant copies dropped by seq
+  uint32_t noBuffer = 0;     // Dropped with the receive pool empty
+  uint32_t fromSelf = 0;     // Our own datagrams looped back
+  uint32_t notForMe = 0;     // Commands addressed to another node
+  uint32_t handled = 0;      // Commands decoded and handled
+  uint32_t unknown = 0;      // Unknown command, or payload too short
+  uint32_t byCmd[Proto::CMD_BATCH] = {};   // Handled, by command code
+};
+
+// Counters since the last rx_class_stats_reset() (or boot).
+void rx_class_stats_get(RxClassStats &out);
+void rx_class_stats_reset();
@@ -16,6 +16,4 @@
 // Starts the over-the-air udpater task.
 //
 // Returns: true on success, false on failure.
-bool ota_start(UBaseType_t priority = 2,
-                uint32_t stack_bytes = 4096,
-                BaseType_t core = 0);
\ No newline at end of file
+bool ota_start();
\ No newline at end of file
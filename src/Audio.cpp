@@ -2,6 +2,7 @@
 #include "DFRobotDFPlayerMini.h"
 
 #include "Audio.h"
+#include "CommandCoalescer.h"
 #include "CommandQueues.h"
 #include "Faults.h"
 #include "IoSync.h"
@@ -22,6 +23,12 @@ bool audio_online = false;
 uint8_t volume = 10; // TODO: Store in config and restore.
 uint8_t folder = 1;  // Assuming all files are in folder "01".
 
+// What the player was last told, so repeated commands can be skipped
+// instead of costing another UART exchange.
+static bool g_playerStopped = true;
+static uint8_t g_playerFile = 0;
+static uint8_t g_playerVolume = 0xFF; // 0xFF = unknown, always send
+
 // Initialize the MP3 audio playback device using a dedicated serial port.
 // We also setup a GPIO input pin to monitor the state of the player to know
 // if it is still working on an audio file.
@@ -133,29 +140,40 @@ void printAudioDetail(uint8_t type, int value)
 void stop_audio_player()
 {
   myDFPlayer.stop();
+  g_playerStopped = true;
   io_printf("Stopping audio playback...");
 }
 
 // Play a file in the specified folder.
-void play_audio_file(uint8_t folder, uint8_t file)
+void play_audio_file(int folder, int file, uint8_t volume)
 {
-  // Special audio file volume override
-  switch(file)
+  // Step parameters take priority over the per file volume.
+  if (volume)
   {
-    case static_cast<int>(AudioAnim::FIRE):
-    set_volume(20);
-    break;
+    set_volume(volume);
+  }
+  else
+  {
+    // Special audio file volume override
+    switch(file)
+    {
+      case static_cast<int>(AudioAnim::FIRE):
+      set_volume(20);
+      break;
 
-    case static_cast<int>(AudioAnim::THERAMIN): 
-    set_volume(25);
-    break;
+      case static_cast<int>(AudioAnim::THERAMIN): 
+      set_volume(25);
+      break;
 
-    case static_cast<int>(AudioAnim::THUNDER):
-    set_volume(20);
-    break;
+      case static_cast<int>(AudioAnim::THUNDER):
+      set_volume(20);
+      break;
+    }
   }
 
   myDFPlayer.playFolder(folder, file);
+  g_playerStopped = false;
+  g_playerFile = (uint8_t)file;
   io_printf("Playing audio folder: %d, file: %d\n", folder, file);
 
 }
@@ -167,13 +185,18 @@ void set_volume(uint8_t volume)
   {
     volume = MP3_MAX_VOLUME;
   }
+  if (volume == g_playerVolume)
+  {
+    return; // Already there
+  }
   myDFPlayer.volume(volume); // Set volume between 0 and 30.
+  g_playerVolume = volume;
   io_printf("Setting audio volume to %d out of %d.", volume, MP3_MAX_VOLUME);
 }
 
-#ifdef USE_MP3_BUSY_PIN
 // Test if we are still busy playing the last audio file.
-// Return true if playing, false if idle.
+// Return true if playing, false if idle.  Audio task only.
+#ifdef USE_MP3_BUSY_PIN
 bool is_audio_playing()
 {
   // The MP3_BUSY_PIN is pulled low when the MP3 player is active.
@@ -187,6 +210,20 @@ bool is_audio_playing()
     return true;
   }
 }
+#else
+bool is_audio_playing()
+{
+  // Without the busy pin, the player's own "play finished" report on the
+  // UART marks the end of the file.
+  while (myDFPlayer.available())
+  {
+    if (myDFPlayer.readType() == DFPlayerPlayFinished)
+    {
+      g_playerStopped = true;
+    }
+  }
+  return !g_playerStopped;
+}
 #endif
 
 static void AudioTask(void *)
@@ -204,10 +241,21 @@ static void AudioTask(void *)
     io_printf("DFPlayer Mini online.\n");
   }
 
+  // Commands wake us; with nothing queued the task stays blocked.
+  queueBus.audioCmdConsumer = xTaskGetCurrentTaskHandle();
+
+  // Every command costs a 9600 baud UART exchange, so a burst is collapsed
+  // first: the latest Play/Stop and the latest Volume survive.
+  CommandCoalescer<AudioCmdQueueMsg, 2> pending;
+
   for (;;)
   {
 
-    if (xQueueReceive(queueBus.audioCmdQueueHandle, &in_msg, 0) == pdPASS)
+    while (RecvAudioQueue(in_msg))
+    {
+      pending.add((in_msg.cmd == AudioQueueCmd::Volume) ? 1 : 0, in_msg);
+    }
+    while (pending.next(in_msg))
     {
       // io_printf("Received incoming audio command: %d, param: %d\n", in_msg.cmd, in_msg.param);
 
@@ -228,22 +276,52 @@ static void AudioTask(void *)
           {
             if (in_msg.param == static_cast<uint8_t>(AudioAnim::SILENCE))
             {
-              stop_audio_player();
+              if (g_playerStopped)
+              {
+                queue_stats_coalesced(BusQueue::Audio, 1);
+              }
+              else
+              {
+                stop_audio_player();
+              }
+            }
+            else if (!g_playerStopped && in_msg.param == g_playerFile && is_audio_playing())
+            {
+              // Same file still playing, let it run but honour the step volume.
+              if (in_msg.params.volume)
+              {
+                set_volume(in_msg.params.volume);
+              }
+              queue_stats_coalesced(BusQueue::Audio, 1);
             }
             else
             {
               // Map the audio animation index to a file on the MP3 SD card.
-              play_audio_file(folder, in_msg.param);
+              play_audio_file(folder, in_msg.param, in_msg.params.volume);
             }
           }
           break;
 
         case AudioQueueCmd::Stop:
-          stop_audio_player();
+          if (g_playerStopped)
+          {
+            queue_stats_coalesced(BusQueue::Audio, 1);
+          }
+          else
+          {
+            stop_audio_player();
+          }
           break;
 
         case AudioQueueCmd::Volume:
-          set_volume(in_msg.param);
+          if (min(in_msg.param, MP3_MAX_VOLUME) == g_playerVolume)
+          {
+            queue_stats_coalesced(BusQueue::Audio, 1);
+          }
+          else
+          {
+            set_volume(in_msg.param);
+          }
           break;
 
         default:
@@ -252,6 +330,7 @@ static void AudioTask(void *)
         }
       }
     }
+    queue_stats_coalesced(BusQueue::Audio, pending.takeEliminated());
 
     // if (myDFPlayer.available())
     // {
@@ -259,14 +338,11 @@ static void AudioTask(void *)
     //   printAudioDetail(myDFPlayer.readType(), myDFPlayer.read());
     // }
 
-    vTaskDelay(pdMS_TO_TICKS(1));
+    bus_wait(portMAX_DELAY);
   }
 }
 
-bool audio_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core)
+bool audio_start()
 {
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      AudioTask, "AudioTask", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+  return static_task_create(TaskId::Audio, AudioTask) != nullptr;
 }
\ No newline at end of file
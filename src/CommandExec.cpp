@@ -3,32 +3,128 @@
 #include "Console.h"
 #include "ConsoleUtils.h"
 #include "Faults.h"
+#include "FleetClock.h"
+#include "FrameJob.h"
 #include "IoSync.h"
 #include "Logging.h"
 #include "main.h"
 #include "NetService.h"
+#include "PeerTable.h"
 #include "ProxDetect.h"
 #include "SettingsStore.h"
+#include "TimerService.h"
 
 
+// Look up a console word in one of the profile name tables.
+// Returns the matching enum value, or -1 if not found.
+static int profile_name_index(const char* const* names, size_t count, const char* word) {
+  for (size_t i = 0; i < count; i++) {
+    if (!strcasecmp(names[i], word)) return (int)i;
+  }
+  return -1;
+}
+
+// Parse a show participation list such as "idle,remote", "all" or "none".
+// Returns true on success.
+static bool parse_show_mask(const char* word, uint8_t& maskOut) {
+  if (!strcasecmp(word, "all"))  { maskOut = SHOW_MASK_ALL; return true; }
+  if (!strcasecmp(word, "none")) { maskOut = 0; return true; }
+
+  char buf[CON_MAX_TOK];
+  strncpy(buf, word, sizeof(buf) - 1);
+  buf[sizeof(buf) - 1] = '\0';
+
+  uint8_t mask = 0;
+  for (char* tok = strtok(buf, ","); tok; tok = strtok(nullptr, ",")) {
+    if (!strcasecmp(tok, "idle"))        mask |= SHOW_MASK_IDLE;
+    else if (!strcasecmp(tok, "local"))  mask |= SHOW_MASK_LOCAL;
+    else if (!strcasecmp(tok, "remote")) mask |= SHOW_MASK_REMOTE;
+    else return false;
+  }
+  maskOut = mask;
+  return true;
+}
+
+// ---- Join cache ----
+// The net task hands each join to this task instead of writing the settings
+// itself, so every SettingsStore change and save runs here and a save never
+// sees a half-written blob.  The wake-up message's command starts with a
+// control character, so it cannot be typed at the console.
+static constexpr const char* JOIN_SAVE_CMD = "\x01join";
+static portMUX_TYPE g_joinMux = portMUX_INITIALIZER_UNLOCKED;
+static NetService::JoinInfo g_pendingJoin;
+static bool g_joinPending = false;
+
+void command_exec_cache_join(const NetService::JoinInfo& joined) {
+  portENTER_CRITICAL(&g_joinMux);
+  g_pendingJoin = joined;
+  g_joinPending = true;
+  portEXIT_CRITICAL(&g_joinMux);
+
+  // With no queue yet, or a full one, the join is still saved when this
+  // task starts or with the next command.
+  QueueHandle_t q = console_get_queue();
+  CommandMsg wake{};
+  strncpy(wake.cmd, JOIN_SAVE_CMD, sizeof(wake.cmd) - 1);
+  if (q) xQueueSend(q, &wake, 0);
+}
+
+// Save the join handed over by the net task, if any; only a change is
+// written.
+static void save_pending_join() {
+  NetService::JoinInfo j;
+  portENTER_CRITICAL(&g_joinMux);
+  const bool pending = g_joinPending;
+  j = g_pendingJoin;
+  g_joinPending = false;
+  portEXIT_CRITICAL(&g_joinMux);
+
+  if (pending && settingsConfig.setWifiJoin(j.bssid, j.channel, j.ip, j.gw, j.mask)) {
+    settingsConfig.save();
+  }
+}
+
 static void CommandExecTask(void*) {
   QueueHandle_t q = console_get_queue();
   CommandMsg msg;
+  save_pending_join();   // A join made before the console queue existed
   while (true) {
-    if (xQueueReceive(q, &msg, portMAX_DELAY) == pdTRUE) {
+    prof_wait_begin();
+    const BaseType_t got = xQueueReceive(q, &msg, portMAX_DELAY);
+    prof_wait_end();
+    if (got == pdTRUE) {
+      save_pending_join();
+      if (!strcmp(msg.cmd, JOIN_SAVE_CMD)) continue;
+
       if (!strcasecmp(msg.cmd, "help")) {
         io_printf(" help           - This list of help commands.\n");
         io_printf(" cfg show       - Show all config items.\n");
         io_printf(" cfg set id x   - Set config device id. (1-254)\n");
         io_printf(" cfg set ssid x - Set WiFi SSID to x.\n");
         io_printf(" cfg set pass x - Set WiFi password to x.\n");
+        io_printf(" cfg set prox x  - Set sensor none/lidar/pir.\n");
+        io_printf(" cfg set motor x - Set motor none/servo/discrete/both.\n");
+        io_printf(" cfg set strip x - Set strip none/ws2812/ws2815.\n");
+        io_printf(" cfg set shows x - Set shows played, e.g. idle,local,remote.\n");
+        io_printf(" cfg set wavestep x - Set wave delay per position in ms. (0=off)\n");
+        io_printf(" cfg set pos id x   - Set walkway position of node id.\n");
+        io_printf(" cfg set ip x       - Set address dhcp, lease (reuse last) or ip gw mask.\n");
         io_printf(" cfg defaults   - Load config defaults.\n");
         io_printf(" cfg load       - Load config from memory.\n");
         io_printf(" cfg save       - Save config to memory.\n");
-        io_printf(" cpu            - Report CPU stats.\n");
+        io_printf(" clock          - Report fleet clock leader, offset and drift.\n");
+        io_printf(" cpu            - Report CPU, heap and per task stats.\n");
         io_printf(" faults         - Report list of active faults.\n");
         io_printf(" net show       - Show network status.\n");        
+        io_printf(" net bench x    - Time x rounds of protocol encode and decode.\n");
+        io_printf(" net stats      - Show receive counters by packet class.\n");
+        io_printf(" net stats reset - Restart the receive counters.\n");
+        io_printf(" queues         - Report command queue health.\n");
+        io_printf(" queues reset   - Clear command queue counters.\n");
+        io_printf(" queues bench x - Time x messages through queue vs ring.\n");
         io_printf(" restart        - Reboot the CPU.\n");
+        io_printf(" timers         - Report timer service wakeups.\n");
+        io_printf(" peers          - Show the peer table and link quality.\n");
         io_printf(" show start     - Enable show mode.\n");
         io_printf(" show stop      - Disable show mode.\n");
         io_printf(" show triglocal  -Trigger a local detection.\n");
@@ -54,6 +150,38 @@ static void CommandExecTask(void*) {
             io_printf(" WiFi SSID: \"%s\" Len: %u\n", settingsConfig.ssid().c_str(), settingsConfig.ssid().length());
             io_printf(" WiFi pass: \"%s\" Len: %u\n", settingsConfig.password().c_str(), settingsConfig.password().length());
             io_printf(" volume:    %u\n", settingsConfig.volume());
+            const NodeProfile profile = settingsConfig.profile();
+            io_printf(" prox:      %s\n", PROX_TYPE_NAMES[static_cast<uint8_t>(profile.proxType)]);
+            io_printf(" motor:     %s\n", MOTOR_TYPE_NAMES[static_cast<uint8_t>(profile.motorType)]);
+            io_printf(" strip:     %s\n", STRIP_MODEL_NAMES[static_cast<uint8_t>(profile.stripModel)]);
+            io_printf(" shows:    %s%s%s\n",
+                      profile.playsShow(SHOW_MASK_IDLE) ? " idle" : "",
+                      profile.playsShow(SHOW_MASK_LOCAL) ? " local" : "",
+                      profile.playsShow(SHOW_MASK_REMOTE) ? " remote" : "");
+            static const char* const IP_MODE_NAMES[] = {"dhcp", "lease", "static"};
+            uint32_t ip = 0, gw = 0, mask = 0;
+            const bool fixed = settingsConfig.staticIp(ip, gw, mask);
+            io_printf(" ip mode:   %s", IP_MODE_NAMES[static_cast<uint8_t>(settingsConfig.ipMode())]);
+            if (fixed) {
+              io_printf(" %s gw %s mask %s", IPAddress(ip).toString().c_str(),
+                        IPAddress(gw).toString().c_str(), IPAddress(mask).toString().c_str());
+            }
+            io_printf("\n");
+            uint8_t bssid[6];
+            uint8_t chan = 0;
+            if (settingsConfig.wifiJoin(bssid, chan, ip, gw, mask)) {
+              io_printf(" last join: %02X:%02X:%02X:%02X:%02X:%02X ch %u, %s\n",
+                        bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], chan,
+                        IPAddress(ip).toString().c_str());
+            } else {
+              io_printf(" last join: none\n");
+            }
+            io_printf(" wavestep:  %u ms\n", settingsConfig.waveStepMs());
+            io_printf(" wave pos: ");
+            for (size_t id = 1; id < Persist::SettingsStore::kMaxWaveNodes; id++) {
+              io_printf(" %u:%u", (unsigned)id, settingsConfig.wavePosition(id));
+            }
+            io_printf("\n");
           }
           else if (!strcasecmp(arg1, "set")) {
             // We need two arguments after set.
@@ -89,6 +217,73 @@ static void CommandExecTask(void*) {
               io_printf("Setting cfg WiFI password to: %s\n", pass);
               settingsConfig.setPassword(pass);
             }
+            // cfg set prox/motor/strip/shows (node profile, applies after save + restart)
+            else if (!strcasecmp(arg2, "prox") || !strcasecmp(arg2, "motor") ||
+                     !strcasecmp(arg2, "strip") || !strcasecmp(arg2, "shows")) {
+              NodeProfile profile = settingsConfig.profile();
+              int idx = -1;
+              if (!strcasecmp(arg2, "prox")) {
+                idx = profile_name_index(PROX_TYPE_NAMES, static_cast<size_t>(ProxType::COUNT), arg3);
+                if (idx >= 0) profile.proxType = static_cast<ProxType>(idx);
+              } else if (!strcasecmp(arg2, "motor")) {
+                idx = profile_name_index(MOTOR_TYPE_NAMES, static_cast<size_t>(MotorType::COUNT), arg3);
+                if (idx >= 0) profile.motorType = static_cast<MotorType>(idx);
+              } else if (!strcasecmp(arg2, "strip")) {
+                idx = profile_name_index(STRIP_MODEL_NAMES, static_cast<size_t>(StripModel::COUNT), arg3);
+                if (idx >= 0) profile.stripModel = static_cast<StripModel>(idx);
+              } else {
+                idx = parse_show_mask(arg3, profile.showMask) ? 0 : -1;
+              }
+              if (idx >= 0) {
+                io_printf("Setting cfg %s to: %s (save and restart to apply)\n", arg2, arg3);
+                settingsConfig.setProfile(profile);
+              } else {
+                io_printf("Invalid %s value: %s\n", arg2, arg3);
+              }
+            }
+            // cfg set ip (applies after save + restart)
+            else if (!strcasecmp(arg2, "ip")) {
+              IPAddress ip, gw, mask;
+              const char* arg4 = arg_as_str(msg, 3);
+              const char* arg5 = arg_as_str(msg, 4);
+              if (!strcasecmp(arg3, "dhcp")) {
+                io_printf("Setting cfg address to DHCP (save and restart to apply)\n");
+                settingsConfig.setIpMode(Persist::SettingsStore::IpMode::Dhcp);
+              } else if (!strcasecmp(arg3, "lease")) {
+                io_printf("Setting cfg address to the last lease (save and restart to apply)\n");
+                settingsConfig.setIpMode(Persist::SettingsStore::IpMode::Lease);
+              } else if (arg4 && arg5 && ip.fromString(arg3) && gw.fromString(arg4) &&
+                         mask.fromString(arg5) && (uint32_t)ip != 0) {
+                io_printf("Setting cfg address to %s gw %s mask %s (save and restart to apply)\n",
+                          arg3, arg4, arg5);
+                settingsConfig.setStaticIp((uint32_t)ip, (uint32_t)gw, (uint32_t)mask);
+              } else {
+                io_printf("Invalid address, usage: cfg set ip dhcp | lease | <ip> <gw> <mask>\n");
+              }
+            }
+            // cfg set wavestep
+            else if (!strcasecmp(arg2, "wavestep")) {
+              int ms = 0;
+              if (arg_as_int(msg, 2, ms) && ms >= 0 && ms <= 1000) {
+                io_printf("Setting cfg wave step to: %d ms\n", ms);
+                settingsConfig.setWaveStepMs((uint16_t)ms);
+              } else {
+                io_printf("Invalid wave step, must be between 0 and 1000 ms!");
+              }
+            }
+            // cfg set pos
+            else if (!strcasecmp(arg2, "pos")) {
+              int id = 0;
+              int pos = 0;
+              if (arg_as_int(msg, 2, id) && arg_as_int(msg, 3, pos) &&
+                  id >= 0 && id < (int)Persist::SettingsStore::kMaxWaveNodes && pos >= 0 && pos <= 255) {
+                io_printf("Setting cfg position of node %d to: %d\n", id, pos);
+                settingsConfig.setWavePosition((uint8_t)id, (uint8_t)pos);
+              } else {
+                io_printf("Invalid position, usage: cfg set pos <id 0-%u> <pos>\n",
+                          (unsigned)(Persist::SettingsStore::kMaxWaveNodes - 1));
+              }
+            }
             else {
               io_printf("Unsupported parameter: %s\n", arg2);
             }
@@ -118,8 +313,18 @@ static void CommandExecTask(void*) {
             io_printf("Unsupported command: %s\n", arg1);
           }
         }
+      } else if (!strcasecmp(msg.cmd, "peers")) {
+        peer_table_print();
+      } else if (!strcasecmp(msg.cmd, "clock")) {
+        fleet_clock_print();
+      } else if (!strcasecmp(msg.cmd, "timers")) {
+        timer_print();
       } else if (!strcasecmp(msg.cmd, "cpu")) {
         io_printf("CPU freq: %d MHz\n", getCpuFrequencyMhz());
+        io_printf("Static task/queue RAM: %u of %u bytes\n",
+                  (unsigned)static_ram_bytes(), (unsigned)STATIC_RAM_BUDGET_BYTES);
+        prof_print();
+        frame_jobs_print();
       } else if (!strcasecmp(msg.cmd, "net")) {
         if (!networkService ) {
           io_printf("Network manager unavailable!");
@@ -138,13 +343,70 @@ static void CommandExecTask(void*) {
             io_printf("  BSSID: %s\n", networkService->bssid().c_str());
             io_printf("  MACADDR: %s\n", networkService->macaddr().c_str());
             io_printf("  Chan: %u\n", networkService->channel());
+            io_printf("  Join: %s in %lu ms, multicast ready %lu ms after boot\n",
+                      networkService->joinPath(), (unsigned long)networkService->joinMs(),
+                      (unsigned long)networkService->readyMs());
             io_printf("  RSSI: %d dBm\n", networkService->rssi());
             io_printf("  McastIP: %s\n", networkService->mcastIP().c_str());
             io_printf("  McastPort: %u\n", networkService->mcastPort());
             io_printf("  Mcast Listening: %s\n", networkService->isListening() ? "LISTENING" : "IDLE");
+            io_printf("  RX: %lu packets, %lu malformed, %lu duplicates, %lu dropped (no buffer), pool peak %u/%u\n",
+                      (unsigned long)networkService->rxPackets(),
+                      (unsigned long)networkService->rxMalformed(),
+                      (unsigned long)networkService->rxDuplicates(),
+                      (unsigned long)networkService->rxNoBuffer(),
+                      networkService->rxPoolPeak(), (unsigned)NetService::RX_POOL_SIZE);
+            const QueueStats txq = queue_stats_get(BusQueue::NetSend);
+            io_printf("  TX: %lu sent, %lu repeat copies, %lu send failures, %lu stale, %lu queue full\n",
+                      (unsigned long)networkService->txSent(),
+                      (unsigned long)networkService->txCopies(),
+                      (unsigned long)networkService->txFailed(),
+                      (unsigned long)networkService->txStale(),
+                      (unsigned long)txq.failed);
+            io_printf("  TX queue: depth %u/%u, high water %lu, %lu bursts (max %u frames)\n",
+                      (unsigned)queue_depth(BusQueue::NetSend), (unsigned)queue_length(BusQueue::NetSend),
+                      (unsigned long)txq.highWater,
+                      (unsigned long)networkService->txBursts(), networkService->txMaxBurst());
+            io_printf("  TX batches: %lu frames carrying %lu messages\n",
+                      (unsigned long)networkService->txBatches(),
+                      (unsigned long)networkService->txBatched());
+            io_printf("  TX repeats lost: %lu too big for a slot, %lu no free slot\n",
+                      (unsigned long)networkService->txRepeatTooBig(),
+                      (unsigned long)networkService->txRepeatNoSlot());
             io_printf(" -------------\n");
 
           }
+          else if (!strcasecmp(arg1, "stats")) {
+            // "net stats [reset]"
+            const char* arg2 = arg_as_str(msg, 1);
+            if (arg2 && !strcasecmp(arg2, "reset")) {
+              rx_class_stats_reset();
+              io_printf("Receive counters restarted.\n");
+            } else {
+              RxClassStats st;
+              rx_class_stats_get(st);
+              io_printf("Receive counters:\n");
+              io_printf("  Datagrams: %lu received, %lu malformed, %lu duplicates, %lu no buffer, %lu from self\n",
+                        (unsigned long)st.datagrams, (unsigned long)st.malformed,
+                        (unsigned long)st.duplicates, (unsigned long)st.noBuffer,
+                        (unsigned long)st.fromSelf);
+              io_printf("  Commands: %lu handled, %lu not for me, %lu unknown or short\n",
+                        (unsigned long)st.handled, (unsigned long)st.notForMe,
+                        (unsigned long)st.unknown);
+              io_printf("  Handled: ping %lu, mode %lu, trigger %lu, time req %lu, time resp %lu\n",
+                        (unsigned long)st.byCmd[Proto::CMD_PING],
+                        (unsigned long)st.byCmd[Proto::CMD_CHANGE_MODE],
+                        (unsigned long)st.byCmd[Proto::CMD_TRIGGER_ANIM],
+                        (unsigned long)st.byCmd[Proto::CMD_TIME_REQ],
+                        (unsigned long)st.byCmd[Proto::CMD_TIME_RESP]);
+            }
+          }
+          else if (!strcasecmp(arg1, "bench")) {
+            // "net bench x"
+            int iterations = 10000;
+            arg_as_int(msg, 1, iterations);
+            proto_benchmark(iterations > 0 ? (uint32_t)iterations : 1);
+          }
           else {
             io_printf("Unsupported command: %s\n", arg1);
           }
@@ -168,7 +430,7 @@ static void CommandExecTask(void*) {
           int index;
           if (arg_as_int(msg, 1, index)) {
             io_printf("Queued up show trigger remote station: %d\n", index);
-            SendShowQueue( ShowInputQueueMsg{ ShowInputQueueCmd::TriggerPeer, static_cast<unsigned char>(index) } );
+            SendShowQueue( ShowInputQueueMsg{ ShowInputQueueCmd::TriggerPeer, 0, static_cast<unsigned char>(index) } );
           } else {
             io_printf("Errr, Missing valid show index!");  
           }
@@ -265,6 +527,20 @@ static void CommandExecTask(void*) {
         io_printf("Active system faults:\n");
         print_faults();
   
+      } else if (!strcasecmp(msg.cmd, "queues")) {
+        const char* arg1 = arg_as_str(msg, 0);
+        if (arg1 && !strcasecmp(arg1, "reset")) {
+          queue_stats_reset();
+          io_printf("Queue counters cleared.\n");
+        } else if (arg1 && !strcasecmp(arg1, "bench")) {
+          int iterations = 10000;
+          arg_as_int(msg, 1, iterations);
+          queue_benchmark(iterations > 0 ? (uint32_t)iterations : 1);
+        } else {
+          io_printf("Command queue health:\n");
+          print_queue_stats();
+        }
+
       } else if (!strcasecmp(msg.cmd, "restart")) {
         io_printf("Rebooting...\n");
         Serial.flush();
@@ -300,9 +576,6 @@ static void CommandExecTask(void*) {
   }
 }
 
-bool command_exec_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core) {
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      CommandExecTask, "CommandExec", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+bool command_exec_start() {
+  return static_task_create(TaskId::CommandExec, CommandExecTask) != nullptr;
 }
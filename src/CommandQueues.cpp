@@ -1,16 +1,187 @@
 #include "CommandQueues.h"
+#include "IoSync.h"
 
 QueueBus queueBus;
 
+static StaticQueue<ShowInputQueueMsg, bus_queue_len(Q_SHOW_INPUT_LEN)> g_showInputQ;
+static StaticQueue<NetSendQueueMsg,   bus_queue_len(Q_NET_SEND_LEN)>   g_netSendQ;
+static StaticQueue<AudioCmdQueueMsg,  bus_queue_len(Q_AUDIO_CMD_LEN)>  g_audioCmdQ;
+static StaticQueue<LightCmdQueueMsg,  bus_queue_len(Q_LIGHT_CMD_LEN)>  g_lightCmdQ;
+static StaticQueue<MotorCmdQueueMsg,  bus_queue_len(Q_MOTOR_CMD_LEN)>  g_motorCmdQ;
+
+// Benchmark queue, so the benchmark takes nothing from the heap either.
+static StaticQueue<LightCmdQueueMsg,  bus_queue_len(Q_LIGHT_CMD_LEN)>  g_benchQ;
+
 bool QueueBus_Init(QueueBus& bus) {
   // Create queues with configured depths and typed element sizes
-  bus.showInputQueueHandle = xQueueCreate(Q_SHOW_INPUT_LEN, sizeof(ShowInputQueueMsg));
-  bus.netSendQueueHandle   = xQueueCreate(Q_NET_SEND_LEN,   sizeof(NetSendQueueMsg));
-  bus.audioCmdQueueHandle  = xQueueCreate(Q_AUDIO_CMD_LEN,  sizeof(AudioCmdQueueMsg));
-  bus.lightCmdQueueHandle  = xQueueCreate(Q_LIGHT_CMD_LEN,  sizeof(LightCmdQueueMsg));
-  bus.motorCmdQueueHandle  = xQueueCreate(Q_MOTOR_CMD_LEN,  sizeof(MotorCmdQueueMsg));
+  bus.showInputQueueHandle = g_showInputQ.create();
+  bus.netSendQueueHandle   = g_netSendQ.create();
+  bus.audioCmdQueueHandle  = g_audioCmdQ.create();
+  bus.lightCmdQueueHandle  = g_lightCmdQ.create();
+  bus.motorCmdQueueHandle  = g_motorCmdQ.create();
 
   const bool ok = bus.showInputQueueHandle && bus.netSendQueueHandle && bus.audioCmdQueueHandle && bus.lightCmdQueueHandle && bus.motorCmdQueueHandle;
 
   return ok;
 }
+
+// ---- Queue health counters ----
+static portMUX_TYPE g_statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const kQueueNames[NUM_BUS_QUEUES] = { "show", "net", "audio", "light", "motor" };
+static const UBaseType_t kQueueLengths[NUM_BUS_QUEUES] = {
+  Q_SHOW_INPUT_LEN, Q_NET_SEND_LEN, Q_AUDIO_CMD_LEN, Q_LIGHT_CMD_LEN, Q_MOTOR_CMD_LEN
+};
+
+static inline QueueStats& stats_of(BusQueue id) {
+  return queueBus.stats[static_cast<size_t>(id)];
+}
+
+// Caller holds g_statsMux.
+static inline void note_sent(QueueStats& st, size_t depth, bool ok) {
+  if (ok) {
+    st.enqueued++;
+    if (depth > st.highWater) st.highWater = depth;
+  } else {
+    st.failed++;
+  }
+}
+
+void queue_stats_sent(BusQueue id, size_t depth, bool ok) {
+  portENTER_CRITICAL(&g_statsMux);
+  note_sent(stats_of(id), depth, ok);
+  portEXIT_CRITICAL(&g_statsMux);
+}
+
+void queue_stats_sent_isr(BusQueue id, size_t depth, bool ok) {
+  portENTER_CRITICAL_ISR(&g_statsMux);
+  note_sent(stats_of(id), depth, ok);
+  portEXIT_CRITICAL_ISR(&g_statsMux);
+}
+
+void queue_stats_received(BusQueue id, uint32_t stampUs) {
+  const uint32_t lat = bus_stamp_us() - stampUs;
+  portENTER_CRITICAL(&g_statsMux);
+  QueueStats& st = stats_of(id);
+  st.dequeued++;
+  st.latLastUs = lat;
+  st.latSumUs += lat;
+  if (lat > st.latMaxUs) st.latMaxUs = lat;
+  portEXIT_CRITICAL(&g_statsMux);
+}
+
+void queue_stats_coalesced(BusQueue id, uint32_t count) {
+  if (count == 0) return;
+  portENTER_CRITICAL(&g_statsMux);
+  stats_of(id).coalesced += count;
+  portEXIT_CRITICAL(&g_statsMux);
+}
+
+QueueStats queue_stats_get(BusQueue id) {
+  portENTER_CRITICAL(&g_statsMux);
+  const QueueStats copy = stats_of(id);
+  portEXIT_CRITICAL(&g_statsMux);
+  return copy;
+}
+
+void queue_stats_reset() {
+  portENTER_CRITICAL(&g_statsMux);
+  for (size_t i = 0; i < NUM_BUS_QUEUES; i++) queueBus.stats[i] = QueueStats{};
+  portEXIT_CRITICAL(&g_statsMux);
+}
+
+const char* queue_name(BusQueue id) {
+  return kQueueNames[static_cast<size_t>(id)];
+}
+
+UBaseType_t queue_length(BusQueue id) {
+  return kQueueLengths[static_cast<size_t>(id)];
+}
+
+size_t queue_depth(BusQueue id) {
+  QueueHandle_t q = nullptr;
+  size_t ring = 0;
+  switch (id) {
+    case BusQueue::ShowInput: q = queueBus.showInputQueueHandle; ring = queueBus.showInputRing.size(); break;
+    case BusQueue::NetSend:   q = queueBus.netSendQueueHandle;   ring = queueBus.netSendRing.size();   break;
+    case BusQueue::Audio:     q = queueBus.audioCmdQueueHandle;  ring = queueBus.audioCmdRing.size();  break;
+    case BusQueue::Light:     q = queueBus.lightCmdQueueHandle;  ring = queueBus.lightCmdRing.size();  break;
+    case BusQueue::Motor:     q = queueBus.motorCmdQueueHandle;  ring = queueBus.motorCmdRing.size();  break;
+    default: break;
+  }
+  return ring + (q ? uxQueueMessagesWaiting(q) : 0);
+}
+
+uint16_t queue_stats_total_failed() {
+  uint32_t total = 0;
+  for (size_t i = 0; i < NUM_BUS_QUEUES; i++) {
+    total += queue_stats_get(static_cast<BusQueue>(i)).failed;
+  }
+  return (total > 0xFFFF) ? 0xFFFF : (uint16_t)total;
+}
+
+uint8_t queue_stats_worst_fill_pct() {
+  uint32_t worst = 0;
+  for (size_t i = 0; i < NUM_BUS_QUEUES; i++) {
+    const BusQueue id = static_cast<BusQueue>(i);
+    const uint32_t pct = queue_stats_get(id).highWater * 100 / queue_length(id);
+    if (pct > worst) worst = pct;
+  }
+  return (uint8_t)worst;
+}
+
+void print_queue_stats() {
+  io_printf(" queue len depth  hw    enq    deq  fail  coal  lat avg/max us\n");
+  for (size_t i = 0; i < NUM_BUS_QUEUES; i++) {
+    const BusQueue id = static_cast<BusQueue>(i);
+    const QueueStats st = queue_stats_get(id);
+    const uint32_t avg = st.dequeued ? (uint32_t)(st.latSumUs / st.dequeued) : 0;
+    io_printf(" %-5s %3u %5u %3u %6lu %6lu %5lu %5lu  %lu/%lu\n",
+              queue_name(id),
+              (unsigned)queue_length(id),
+              (unsigned)queue_depth(id),
+              (unsigned)st.highWater,
+              (unsigned long)st.enqueued,
+              (unsigned long)st.dequeued,
+              (unsigned long)st.failed,
+              (unsigned long)st.coalesced,
+              (unsigned long)avg,
+              (unsigned long)st.latMaxUs);
+  }
+}
+
+// ---- Transport benchmark ----
+// Both paths are timed single-threaded (send then receive, no blocking) so
+// the numbers are the raw per-message cost of each transport.
+void queue_benchmark(uint32_t iterations) {
+  if (iterations == 0) iterations = 1;
+  static QueueHandle_t q = g_benchQ.create();
+  if (!q) {
+    io_printf("Benchmark queue creation failed!\n");
+    return;
+  }
+  static SpscRing<LightCmdQueueMsg, bus_ring_len(Q_LIGHT_CMD_LEN)> ring;
+  LightCmdQueueMsg out{ LightQueueCmd::Play, 1 };
+  LightCmdQueueMsg in{};
+
+  uint32_t start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < iterations; i++) {
+    out.stampUs = i;
+    xQueueSend(q, &out, 0);
+    xQueueReceive(q, &in, 0);
+  }
+  const uint32_t queueCycles = ESP.getCycleCount() - start;
+
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < iterations; i++) {
+    out.stampUs = i;
+    ring.push(out);
+    ring.pop(in);
+  }
+  const uint32_t ringCycles = ESP.getCycleCount() - start;
+
+  io_printf("%lu messages of %u bytes, send+receive:\n",
+            (unsigned long)iterations, (unsigned)sizeof(LightCmdQueueMsg));
+  io_printf("  FreeRTOS queue: %lu cycles/msg\n", (unsigned long)(queueCycles / iterations));
+  io_printf("  SPSC ring:      %lu cycles/msg\n", (unsigned long)(ringCycles / iterations));
+}
@@ -1,6 +1,7 @@
 #include "Console.h"
 #include "IoSync.h"
 #include "Logging.h"
+#include "TimerService.h"
 
 
 static const char* TAG_CON = "console";
@@ -43,57 +44,51 @@ static void tokenize_line(const String& line, CommandMsg& out)
   if (tok.length()) { push_tok(tok, first); }
 }
 
-static void ConsoleReaderTask(void* /*pv*/)
+// Runs on the timer service every CON_POLL_MS.
+static void console_poll(void* /*arg*/)
 {
-  String line;
-  ESP_LOGI(TAG_CON, "Console reader on core %d. Type 'help' + Enter.", core_id());
-  //io_printf("> ");
+  static String line;
 
-  while (true) {
-    while (Serial.available()) {
-      char c = (char)Serial.read();
-      if (c == '\r') continue;
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\r') continue;
 
-      if (c == '\n') {
-        line.trim();
-        if (line.length() > 0) {
-          CommandMsg msg;
-          tokenize_line(line, msg);
-          if (msg.cmd[0] != '\0' && g_cmdq) {
-            xQueueSend(g_cmdq, &msg, 0);
-          }
-        }
-        line = "";
-      } else {
-        // simple backspace handling
-        if ((c == 0x08 || c == 0x7F)) {
-          if (line.length() > 0) line.remove(line.length() - 1);
-        } else if (isPrintable(c)) {
-          line += c;
+    if (c == '\n') {
+      line.trim();
+      if (line.length() > 0) {
+        CommandMsg msg;
+        tokenize_line(line, msg);
+        if (msg.cmd[0] != '\0' && g_cmdq) {
+          xQueueSend(g_cmdq, &msg, 0);
         }
       }
+      line = "";
+    } else {
+      // simple backspace handling
+      if ((c == 0x08 || c == 0x7F)) {
+        if (line.length() > 0) line.remove(line.length() - 1);
+      } else if (isPrintable(c)) {
+        line += c;
+      }
     }
-    vTaskDelay(pdMS_TO_TICKS(10));
   }
 }
 
-QueueHandle_t console_start(size_t queue_len, UBaseType_t task_priority, uint32_t stack_bytes, BaseType_t core)
+QueueHandle_t console_start()
 {
+  static StaticQueue<CommandMsg, CON_QUEUE_LEN> cmdqStore;
   if (!g_cmdq) {
-    g_cmdq = xQueueCreate(queue_len, sizeof(CommandMsg));
+    g_cmdq = cmdqStore.create();
     if (!g_cmdq) {
       ESP_LOGE(TAG_CON, "Failed to create command queue");
       return nullptr;
     }
   }
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      ConsoleReaderTask, "ConsoleReader", stack_bytes, nullptr, task_priority, nullptr, core);
-  if (ok != pdPASS) {
-    ESP_LOGE(TAG_CON, "Failed to start ConsoleReader task");
-    vQueueDelete(g_cmdq);
-    g_cmdq = nullptr;
+  if (timer_every(CON_POLL_MS, CON_POLL_SLACK_MS, console_poll) < 0) {
+    ESP_LOGE(TAG_CON, "Failed to start console poll timer");
     return nullptr;
   }
+  ESP_LOGI(TAG_CON, "Console reader on core %d. Type 'help' + Enter.", core_id());
   return g_cmdq;
 }
 
@@ -17,7 +17,7 @@ const char *FAULT_STRING[] = {
   "MP3_PLAYER_INIT_FAIL",
   "UNDEFINED_FAULT",
   "UNDEFINED_FAULT",
-  "UNDEFINED_FAULT",
+  "TIMER_SERVICE_FAULT",
   "UNDEFINED_FAULT",
   "UNDEFINED_FAULT",
   "UNDEFINED_FAULT",
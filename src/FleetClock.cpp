@@ -0,0 +1,385 @@
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "FleetClock.h"
+#include "IoSync.h"
+#include "main.h"
+#include "PeerTable.h"
+
+// Number of recent ping offset samples kept per leader.  One-way samples are
+// always late by the network delay, so the largest (fleet - local) in the
+// window is the one with the least delay and the best estimate.  Only used
+// until the first exchange completes.
+static constexpr uint8_t OFFSET_WINDOW = 8;
+
+// Round trips remembered for the delay gate.
+static constexpr uint8_t SYNC_WINDOW = 16;
+
+// Give up the fast request rate after this many requests without a full
+// window (the leader may be running older firmware).
+static constexpr uint8_t SYNC_FAST_MAX_REQUESTS = 2 * SYNC_WINDOW;
+
+// Answers slower than this sat in a queue or behind a DTIM; no timing left.
+static constexpr int64_t SYNC_MAX_RTT_US = 250000;
+
+// An exchange is used only if its round trip is within a quarter plus this
+// of the fastest recent one.  Extra delay is rarely split evenly both ways,
+// so slow exchanges carry most of the offset error.
+static constexpr uint32_t SYNC_RTT_SLACK_US = 500;
+
+// Exchanges that passed the gate, kept for the drift fit.
+static constexpr uint8_t SYNC_POINTS = 16;
+
+// The fit needs the kept exchanges to span at least this long before its
+// slope means anything; until then the drift is left alone.
+static constexpr int64_t SYNC_MIN_SPAN_US = 4000000;
+
+// Crystals are good to tens of ppm; anything faster is a step, not drift.
+static constexpr int64_t SYNC_MAX_DRIFT_PPB = 200000;
+
+struct SyncPoint
+{
+  uint64_t localUs;    // Local time the offset applies at
+  int64_t  offsetUs;   // fleet - local
+};
+
+// Answer owed to a requester
+struct PendingReply
+{
+  uint64_t t1;
+  uint64_t t2;
+  bool     valid;
+};
+
+static portMUX_TYPE g_clockMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t  g_leader = 0xFF;      // 0xFF = no leader heard yet
+static uint32_t g_leaderSeenMs = 0;
+static int32_t  g_offsetMs = 0;       // fleet - local, from pings
+static int32_t  g_samples[OFFSET_WINDOW];
+static uint8_t  g_sampleCount = 0;
+static uint8_t  g_sampleNext = 0;
+
+// ---- Exchange filter (requester side) ----
+static uint32_t   g_rtts[SYNC_WINDOW];
+static uint8_t    g_rttCount = 0;
+static uint8_t    g_rttNext = 0;
+static SyncPoint  g_points[SYNC_POINTS];
+static uint8_t    g_pointCount = 0;
+static uint8_t    g_pointNext = 0;
+static SyncPoint  g_base;             // Fitted offset in use
+static int32_t    g_driftPpb = 0;     // d(fleet - local)/d(local), parts per billion
+static uint8_t    g_requests = 0;     // Sent since the leader changed, saturating
+static uint32_t   g_exchanges = 0;
+static uint32_t   g_gated = 0;        // Answered, but too slow to use
+static uint32_t   g_rejected = 0;     // Not from the leader, or no timing
+static uint32_t   g_lastRttUs = 0;
+static uint32_t   g_minRttUs = 0;
+
+// ---- Responder side ----
+static PendingReply g_pending[PEER_MAX_NODES];
+static uint32_t     g_answered = 0;
+
+// True when the remembered leader has gone quiet or we outrank it.
+static bool leader_expired(uint32_t now_ms)
+{
+  return (g_leader == 0xFF) ||
+         (g_leader >= settingsConfig.deviceId()) ||
+         (now_ms - g_leaderSeenMs > FLEET_LEADER_TIMEOUT_MS);
+}
+
+// New (or better) leader: restart every estimate.  Lock held.
+static void follow_leader(uint8_t src)
+{
+  g_leader = src;
+  g_sampleCount = 0;
+  g_sampleNext = 0;
+  g_rttCount = 0;
+  g_rttNext = 0;
+  g_pointCount = 0;
+  g_pointNext = 0;
+  g_driftPpb = 0;
+  g_requests = 0;
+}
+
+// fleet - local at local time local_us.  Lock held.
+static int64_t offset_at(uint64_t local_us, uint32_t now_ms)
+{
+  if (leader_expired(now_ms))
+  {
+    return 0;
+  }
+  if (g_pointCount == 0)
+  {
+    return (int64_t)g_offsetMs * 1000;
+  }
+  const int64_t elapsed = (int64_t)(local_us - g_base.localUs);
+  return g_base.offsetUs + elapsed * g_driftPpb / 1000000000;
+}
+
+uint64_t fleet_from_local_us(uint64_t local_us)
+{
+  const uint32_t now = millis();
+  int64_t offset;
+  portENTER_CRITICAL(&g_clockMux);
+  offset = offset_at(local_us, now);
+  portEXIT_CRITICAL(&g_clockMux);
+  return local_us + (uint64_t)offset;
+}
+
+uint64_t fleet_time_us()
+{
+  return fleet_from_local_us((uint64_t)esp_timer_get_time());
+}
+
+uint32_t fleet_time_ms()
+{
+  return (uint32_t)(fleet_time_us() / 1000);
+}
+
+uint32_t fleet_to_local_ms(uint32_t fleet_ms)
+{
+  return fleet_ms - (fleet_time_ms() - millis());
+}
+
+void fleet_clock_observe(uint8_t src, uint32_t peer_fleet_ms, uint32_t rx_local_ms)
+{
+  // Only nodes numbered below us can be our time reference.
+  if (src >= settingsConfig.deviceId())
+  {
+    return;
+  }
+
+  portENTER_CRITICAL(&g_clockMux);
+  if (leader_expired(rx_local_ms) || src < g_leader)
+  {
+    follow_leader(src);
+  }
+
+  if (src == g_leader)
+  {
+    g_leaderSeenMs = rx_local_ms;
+    g_samples[g_sampleNext] = (int32_t)(peer_fleet_ms - rx_local_ms);
+    g_sampleNext = (g_sampleNext + 1) % OFFSET_WINDOW;
+    if (g_sampleCount < OFFSET_WINDOW)
+    {
+      g_sampleCount++;
+    }
+
+    int32_t best = g_samples[0];
+    for (uint8_t i = 1; i < g_sampleCount; i++)
+    {
+      if (g_samples[i] > best)
+      {
+        best = g_samples[i];
+      }
+    }
+    g_offsetMs = best;
+  }
+  portEXIT_CRITICAL(&g_clockMux);
+}
+
+uint8_t fleet_clock_sync_target(bool beat)
+{
+  const uint32_t now = millis();
+  uint8_t target = 0xFF;
+  portENTER_CRITICAL(&g_clockMux);
+  if (!leader_expired(now))
+  {
+    const bool filling = g_rttCount < SYNC_WINDOW && g_requests < SYNC_FAST_MAX_REQUESTS;
+    if (filling || beat)
+    {
+      if (g_requests < 0xFF)
+      {
+        g_requests++;
+      }
+      target = g_leader;
+    }
+  }
+  portEXIT_CRITICAL(&g_clockMux);
+  return target;
+}
+
+bool fleet_clock_request_rx(uint8_t src, uint64_t t1, uint64_t rx_local_us)
+{
+  if (src >= PEER_MAX_NODES)
+  {
+    return false;
+  }
+  const uint64_t t2 = fleet_from_local_us(rx_local_us);
+  portENTER_CRITICAL(&g_clockMux);
+  g_pending[src] = PendingReply{t1, t2, true};
+  portEXIT_CRITICAL(&g_clockMux);
+  return true;
+}
+
+bool fleet_clock_response(uint8_t dst, uint64_t &t1, uint64_t &t2)
+{
+  if (dst >= PEER_MAX_NODES)
+  {
+    return false;
+  }
+  bool valid;
+  portENTER_CRITICAL(&g_clockMux);
+  PendingReply &p = g_pending[dst];
+  valid = p.valid;
+  t1 = p.t1;
+  t2 = p.t2;
+  p.valid = false;
+  if (valid)
+  {
+    g_answered++;
+  }
+  portEXIT_CRITICAL(&g_clockMux);
+  return valid;
+}
+
+void fleet_clock_exchange(uint8_t src, uint64_t t1, uint64_t t2, uint64_t t3,
+                          uint64_t rx_local_us)
+{
+  const uint64_t t4 = rx_local_us;
+  const int64_t rtt = (int64_t)(t4 - t1) - (int64_t)(t3 - t2);
+  const int64_t offset = ((int64_t)(t2 - t1) + (int64_t)(t3 - t4)) / 2;
+  const uint32_t now = millis();
+
+  portENTER_CRITICAL(&g_clockMux);
+  if (leader_expired(now) || src != g_leader || t4 < t1 || rtt < 0 || rtt > SYNC_MAX_RTT_US)
+  {
+    g_rejected++;
+    portEXIT_CRITICAL(&g_clockMux);
+    return;
+  }
+
+  g_leaderSeenMs = now;
+  g_lastRttUs = (uint32_t)rtt;
+  g_exchanges++;
+  g_rtts[g_rttNext] = (uint32_t)rtt;
+  g_rttNext = (g_rttNext + 1) % SYNC_WINDOW;
+  if (g_rttCount < SYNC_WINDOW)
+  {
+    g_rttCount++;
+  }
+  uint32_t minRtt = g_rtts[0];
+  for (uint8_t i = 1; i < g_rttCount; i++)
+  {
+    if (g_rtts[i] < minRtt)
+    {
+      minRtt = g_rtts[i];
+    }
+  }
+  g_minRttUs = minRtt;
+  if ((uint32_t)rtt > minRtt + minRtt / 4 + SYNC_RTT_SLACK_US)
+  {
+    g_gated++;
+    portEXIT_CRITICAL(&g_clockMux);
+    return;
+  }
+
+  // The offset holds at the midpoint of the exchange.
+  const SyncPoint newest{t1 + (t4 - t1) / 2, offset};
+  g_points[g_pointNext] = newest;
+  g_pointNext = (g_pointNext + 1) % SYNC_POINTS;
+  if (g_pointCount < SYNC_POINTS)
+  {
+    g_pointCount++;
+  }
+
+  // Least squares line through the kept points, relative to the newest so
+  // the sums stay well inside 64 bits (x within a minute, y within a few
+  // ms once gated).
+  int64_t sumX = 0, sumY = 0, oldest = 0;
+  for (uint8_t i = 0; i < g_pointCount; i++)
+  {
+    const int64_t x = (int64_t)(g_points[i].localUs - newest.localUs);
+    sumX += x;
+    sumY += g_points[i].offsetUs - newest.offsetUs;
+    if (x < oldest)
+    {
+      oldest = x;
+    }
+  }
+  const int64_t meanX = sumX / g_pointCount;
+  const int64_t meanY = sumY / g_pointCount;
+  if (-oldest >= SYNC_MIN_SPAN_US)
+  {
+    int64_t sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < g_pointCount; i++)
+    {
+      const int64_t dx = (int64_t)(g_points[i].localUs - newest.localUs) - meanX;
+      const int64_t dy = g_points[i].offsetUs - newest.offsetUs - meanY;
+      sxx += dx * dx;
+      sxy += dx * dy;
+    }
+    int64_t ppb = sxy * 1000 / (sxx / 1000000);
+    if (ppb > SYNC_MAX_DRIFT_PPB)
+    {
+      ppb = SYNC_MAX_DRIFT_PPB;
+    }
+    else if (ppb < -SYNC_MAX_DRIFT_PPB)
+    {
+      ppb = -SYNC_MAX_DRIFT_PPB;
+    }
+    g_driftPpb = (int32_t)ppb;
+  }
+  // The line's value at the newest point.
+  g_base = SyncPoint{newest.localUs,
+                     newest.offsetUs + meanY - meanX * g_driftPpb / 1000000000};
+  portEXIT_CRITICAL(&g_clockMux);
+}
+
+uint8_t fleet_clock_leader()
+{
+  const uint32_t now = millis();
+  uint8_t leader;
+  portENTER_CRITICAL(&g_clockMux);
+  leader = leader_expired(now) ? settingsConfig.deviceId() : g_leader;
+  portEXIT_CRITICAL(&g_clockMux);
+  return leader;
+}
+
+int32_t fleet_clock_offset_ms()
+{
+  return (int32_t)(fleet_time_ms() - millis());
+}
+
+void fleet_clock_print()
+{
+  const uint64_t local = (uint64_t)esp_timer_get_time();
+  const uint32_t now = millis();
+  bool following;
+  uint8_t leader;
+  int64_t offset;
+  int32_t drift;
+  uint32_t points, exchanges, gated, rejected, minRtt, lastRtt, answered;
+  portENTER_CRITICAL(&g_clockMux);
+  following = !leader_expired(now);
+  leader = g_leader;
+  offset = offset_at(local, now);
+  points = g_pointCount;
+  drift = g_driftPpb;
+  exchanges = g_exchanges;
+  gated = g_gated;
+  rejected = g_rejected;
+  minRtt = g_minRttUs;
+  lastRtt = g_lastRttUs;
+  answered = g_answered;
+  portEXIT_CRITICAL(&g_clockMux);
+
+  io_printf("Fleet clock:\n");
+  if (following)
+  {
+    io_printf("  Leader: node %u\n", leader);
+  }
+  else
+  {
+    io_printf("  Leader: self (node %u)\n", settingsConfig.deviceId());
+  }
+  io_printf("  Now: local %llu us, fleet %llu us\n",
+            (unsigned long long)local, (unsigned long long)(local + (uint64_t)offset));
+  const uint32_t absDrift = (uint32_t)(drift < 0 ? -drift : drift);
+  io_printf("  Offset: %lld us (%s), drift %c%lu.%03lu ppm\n",
+            (long long)offset, !following ? "none" : points ? "exchange" : "ping",
+            drift < 0 ? '-' : '+', (unsigned long)(absDrift / 1000), (unsigned long)(absDrift % 1000));
+  io_printf("  Exchanges: %lu, %lu gated as slow, %lu rejected; rtt %lu us min, %lu us last\n",
+            (unsigned long)exchanges, (unsigned long)gated, (unsigned long)rejected,
+            (unsigned long)minRtt, (unsigned long)lastRtt);
+  io_printf("  Requests answered: %lu\n", (unsigned long)answered);
+}
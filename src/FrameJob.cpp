@@ -0,0 +1,134 @@
+#include "FrameJob.h"
+#include "CommandQueues.h"
+#include "esp_timer.h"
+#include "IoSync.h"
+
+static FrameJob* g_jobs[FRAME_MAX_JOBS];
+static size_t    g_numJobs = 0;
+
+// FreeRTOS wakes on tick boundaries, so a timed wait can end up to one tick
+// before the microsecond due time.  Treat that as on time.
+static constexpr uint32_t TICK_US = portTICK_PERIOD_MS * 1000;
+
+static inline uint32_t now_us() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+// Due for a timed run, or woken by a command it listens for.
+static bool job_ready(const FrameJob& j, uint32_t events) {
+  if (events & j.wakeBits) return true;
+  return !j.idle && (int32_t)(now_us() - j.dueUs) > -(int32_t)TICK_US;
+}
+
+// Ticks until the job is next due.
+static TickType_t job_wait(const FrameJob& j) {
+  if (j.idle) return portMAX_DELAY;
+  const int32_t left = (int32_t)(j.dueUs - now_us());
+  if (left <= 0) return 0;
+  return pdMS_TO_TICKS(((uint32_t)left + 999) / 1000);
+}
+
+static void job_run(FrameJob& j, uint32_t events) {
+  FrameJobStats& st = j.stats;
+  const uint32_t start = now_us();
+  const int32_t late = (int32_t)(start - j.dueUs);
+  if (!j.idle && late > -(int32_t)TICK_US) {
+    const uint32_t lateUs = late > 0 ? (uint32_t)late : 0;
+    st.timedRuns++;
+    st.lateSumUs += lateUs;
+    if (lateUs > st.lateMaxUs) st.lateMaxUs = lateUs;
+    if (lateUs > FRAME_JOB_SLACK_US) st.misses++;
+  }
+
+  const TickType_t wait = j.step(events & j.wakeBits);
+
+  const uint32_t end = now_us();
+  const uint32_t exec = end - start;
+  st.runs++;
+  st.execSumUs += exec;
+  if (exec > st.execMaxUs) st.execMaxUs = exec;
+
+  j.idle = (wait == portMAX_DELAY);
+  j.dueUs = end + wait * TICK_US;
+}
+
+static void job_begin(FrameJob& j) {
+  j.init();
+  j.dueUs = now_us();
+  j.idle = false;
+}
+
+#if defined(USE_FRAME_EXECUTOR)
+
+// ---- Executor: every job on one task ----
+static void FrameExecTask(void*) {
+  for (size_t i = 0; i < g_numJobs; i++) {
+    job_begin(*g_jobs[i]);
+  }
+
+  uint32_t events = 0;
+  for (;;) {
+    TickType_t wait = portMAX_DELAY;
+    for (size_t i = 0; i < g_numJobs; i++) {
+      FrameJob& j = *g_jobs[i];
+      if (job_ready(j, events)) job_run(j, events);
+    }
+    for (size_t i = 0; i < g_numJobs; i++) {
+      const TickType_t w = job_wait(*g_jobs[i]);
+      if (w < wait) wait = w;
+    }
+    events = bus_wait(wait);
+  }
+}
+
+bool frame_exec_start() {
+  return static_task_create(TaskId::FrameExec, FrameExecTask) != nullptr;
+}
+
+#else
+
+// ---- One task per job ----
+static void FrameJobTask(void* arg) {
+  FrameJob& j = *static_cast<FrameJob*>(arg);
+  job_begin(j);
+
+  uint32_t events = 0;
+  for (;;) {
+    if (job_ready(j, events)) job_run(j, events);
+    events = bus_wait(job_wait(j));
+  }
+}
+
+#endif
+
+bool frame_job_start(FrameJob& job, TaskId id) {
+  if (g_numJobs >= FRAME_MAX_JOBS) return false;
+  g_jobs[g_numJobs++] = &job;
+#if defined(USE_FRAME_EXECUTOR)
+  (void)id;
+  return true;
+#else
+  return static_task_create(id, FrameJobTask, &job) != nullptr;
+#endif
+}
+
+void frame_jobs_print() {
+#if defined(USE_FRAME_EXECUTOR)
+  io_printf("Frame jobs (executor):\n");
+#else
+  io_printf("Frame jobs (one task each):\n");
+#endif
+  io_printf(" %-8s %8s %8s %6s %6s %8s %8s %8s\n",
+            "job", "runs", "timed", "miss", "late", "late max", "exec", "exec max");
+  for (size_t i = 0; i < g_numJobs; i++) {
+    const FrameJob& j = *g_jobs[i];
+    const FrameJobStats st = j.stats;
+    const uint32_t lateAvg = st.timedRuns ? (uint32_t)(st.lateSumUs / st.timedRuns) : 0;
+    const uint32_t execAvg = st.runs ? (uint32_t)(st.execSumUs / st.runs) : 0;
+    io_printf(" %-8s %8lu %8lu %6lu %6lu %8lu %8lu %8lu\n", j.name,
+              (unsigned long)st.runs, (unsigned long)st.timedRuns, (unsigned long)st.misses,
+              (unsigned long)lateAvg, (unsigned long)st.lateMaxUs,
+              (unsigned long)execAvg, (unsigned long)st.execMaxUs);
+  }
+  io_printf(" (late and exec in us)\n");
+}
@@ -17,8 +17,9 @@ static int locked_vprintf(const char* fmt, va_list args)
 
 void io_sync_init()
 {
+  static StaticSemaphore_t ioMtxBuf;
   if (!g_ioMtx) {
-    g_ioMtx = xSemaphoreCreateMutex();
+    g_ioMtx = xSemaphoreCreateMutexStatic(&ioMtxBuf);
   }
   esp_log_set_vprintf(locked_vprintf);
 }
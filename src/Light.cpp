@@ -1,10 +1,13 @@
 #include <Arduino.h>
 #include <FastLED.h>
 
+#include "CommandCoalescer.h"
 #include "CommandQueues.h"
+#include "FrameJob.h"
 #include "IoSync.h"
 #include "Light.h"
 #include "Logging.h"
+#include "NodeProfile.h"
 #include "Pins.h"
 
 // Animation sequences
@@ -24,9 +27,7 @@
 //    360 degree silicon and nylon diffusers.
 //    https://www.amazon.com/dp/B0CRVDGMW9?ref=ppx_yo2ov_dt_b_fed_asin_title&th=1
 
-// Uncomment only ONE of the following light strip models in use.
-//#define ALITOVE_WS2815_12V_5M_STRIP
-#define XNBADA_WS2812_12V_5M_STRIP
+// The strip model in use is selected in NodeProfile.h.
 
 // Addressable LED light strip config.
 #if defined(ALITOVE_WS2815_12V_5M_STRIP)
@@ -69,9 +70,12 @@ static uint16_t g_targetFps = LIGHT_FPS_DEFAULT;
 static bool g_playing = false;
 static uint8_t g_animIndex = static_cast<uint8_t>(LightAnim::BLANK);
 static bool g_animReset = true; // set true on animation change
+static StepParams g_params{};   // look of the playing animation (defaults + step)
+static TaskHandle_t g_lightTask = nullptr;
 
 // ---------- Helpers ----------
 static inline uint32_t now_ms() { return (uint32_t)(esp_timer_get_time() / 1000ULL); }
+static inline CRGB param_color(const uint8_t c[3]) { return CRGB(c[0], c[1], c[2]); }
 
 void light_set_brightness(uint8_t b)
 {
@@ -112,6 +116,11 @@ static void anim_blank(bool reset)
 //
 static void anim_flames(bool reset)
 {
+  if (reset)
+  {
+    flames.setCooling(g_params.cooling);
+    flames.setSparking(g_params.sparking);
+  }
   flames.update(reset);
   // copy the generated frame into the strip buffer used by FastLED
   flames.blitTo(g_leds, NUM_LEDS);
@@ -140,29 +149,6 @@ static void anim_lightning_bolts(bool reset)
 
 
 
-// CANDYCANE: moving red/white stripes.
-static void anim_candycane(bool reset)
-{
-  static uint32_t t0 = 0;
-  if (reset)
-  {
-    t0 = now_ms();
-    fill_solid(g_leds, NUM_LEDS, CRGB::Black);
-  }
-
-  const uint32_t t = now_ms() - t0;
-  const uint8_t stripeWidth = 3;      // pixels per color block
-  const uint8_t speedMsPerShift = 90; // lower = faster
-  const int offset = (t / speedMsPerShift) % (stripeWidth * 2);
-
-  for (int i = 0; i < NUM_LEDS; ++i)
-  {
-    const int band = ((i + offset) / stripeWidth) & 1;
-    g_leds[i] = band ? CRGB(220, 0, 0) : CRGB::White;
-  }
-}
-
-
 // BOUNCE: single bright pixel bouncing back & forth with fading trail.
 static void anim_bounce(bool reset)
 {
@@ -195,22 +181,23 @@ static void anim_bounce(bool reset)
   }
 }
 
-// ---------- Portal + Sparkles Animations ----------
-static void anim_portal_halloween(bool reset)
+// ---------- Portal Animation ----------
+//
+// Moving two color bands.  Candy cane, Halloween and red/white portals are
+// all this one effect with different step parameters.
+static void anim_portal(bool reset)
 {
-    // Portal: purple & orange
-  const CRGB PURPLE(160, 0, 200);
-  const CRGB ORANGE(255, 80, 0);
-  
-  portal.setColors(PURPLE, ORANGE);
-  portal.setBandWidth(6);          // bold, readable bands
-  portal.setSpeedMsPerShift(70);   // lower = faster
-  portal.setDirection(+1);         // scroll direction
+  if (reset)
+  {
+    portal.setColors(param_color(g_params.colorA), param_color(g_params.colorB));
+    portal.setBandWidth(g_params.bandWidth);
+    portal.setSpeedMsPerShift(g_params.speedMs);
+    portal.setDirection(g_params.direction);
+  }
   portal.update(reset);
   portal.blitTo(g_leds, NUM_LEDS);
 
   // Uncomment to add sparkle effect
-  // // Sparkle flavor for Halloween
   // if (reset) sparkle.reset();
   // sparkle.setRate(10.0f);       // births/sec
   // sparkle.setLifetime(90, 200); // ms
@@ -219,116 +206,158 @@ static void anim_portal_halloween(bool reset)
   // sparkle.apply(g_leds, NUM_LEDS);
 }
 
-static void anim_portal_redwhite(bool reset)
-{
-
-  // Portal: white & red
-  portal.setColors(CRGB::White, CRGB(220, 0, 0));
-  portal.setBandWidth(5);
-  portal.setSpeedMsPerShift(70);
-  portal.setDirs(+1, -1);
-  portal.update(reset);
-  portal.blitTo(g_leds, NUM_LEDS);
-
-  // Uncomment to add sparkle effect
-  // // Sparkle flavor (a bit lighter)
-  // if (reset) sparkle.reset();
-  // sparkle.setRate(6.0f);
-  // sparkle.setLifetime(70, 150);
-  // sparkle.setIntensity(255);
-  // sparkle.setMaxActive(20);
-  // sparkle.apply(g_leds, NUM_LEDS);
-}
-
 
 // Dispatch table, must match mapping in Light.h for animations.
 typedef void (*AnimFn)(bool reset);
 static AnimFn kAnims[NUM_LIGHT_ANIMATIONS] = {
   anim_blank, 
-  anim_candycane,
+  anim_portal,
   anim_flames,
   anim_bounce,
   anim_lightning_bolts,
-  anim_portal_halloween,
-  anim_portal_redwhite
+  anim_portal,
+  anim_portal
+};
+
+// Animations whose first frame never changes, no need to re-render them.
+static const bool kStaticAnim[NUM_LIGHT_ANIMATIONS] = {
+  true,   // BLANK
+  false,  // CANDYCANE
+  false,  // FLAMES
+  false,  // BOUNCE
+  false,  // LIGHTNING
+  false,  // PORTAL_HALLOWEEN
+  false   // PORTAL_REDWHITE
 };
 
-// Master LightTask
+// Default look of each animation, must match mapping in Light.h.  Step
+// parameters override individual fields of these.
+static const StepParams kLookDefaults[NUM_LIGHT_ANIMATIONS] = {
+  // BLANK
+  {},
+  // CANDYCANE: red/white stripes
+  { .flags = STEP_PARAM_COLORS, .colorA = {220, 0, 0}, .colorB = {255, 255, 255},
+    .bandWidth = 3, .speedMs = 90, .direction = +1 },
+  // FLAMES
+  { .flags = 0, .colorA = {}, .colorB = {}, .bandWidth = 0, .speedMs = 0, .direction = 0,
+    .cooling = 85, .sparking = 75 },
+  // BOUNCE
+  {},
+  // LIGHTNING
+  {},
+  // PORTAL_HALLOWEEN: purple & orange, bold readable bands
+  { .flags = STEP_PARAM_COLORS, .colorA = {160, 0, 200}, .colorB = {255, 80, 0},
+    .bandWidth = 6, .speedMs = 70, .direction = +1 },
+  // PORTAL_REDWHITE: white & red
+  { .flags = STEP_PARAM_COLORS, .colorA = {255, 255, 255}, .colorB = {220, 0, 0},
+    .bandWidth = 5, .speedMs = 70, .direction = +1 },
+};
+
+// Light frame job (see FrameJob.h)
 //
-static void LightTask(void *)
+static FramePacer g_pacer(0);  // Frame length set from g_targetFps at init
+
+static void light_job_init()
 {
   io_printf("[Light] Task started. num=%d, pin=%d, fps=%u, brightness=%u\n",
             NUM_LEDS, LED_PIN, (unsigned)g_targetFps, (unsigned)g_brightness);
 
-  const TickType_t frameTicks = pdMS_TO_TICKS(1000UL / g_targetFps);
-  TickType_t lastWake = xTaskGetTickCount();
+  g_pacer.frameTicks = pdMS_TO_TICKS(1000UL / g_targetFps);
+  g_lightTask = xTaskGetCurrentTaskHandle();
+  queueBus.lightCmdConsumer = g_lightTask;
+}
 
+static TickType_t light_job_step(uint32_t events)
+{
   LightCmdQueueMsg msg{};
+  CommandCoalescer<LightCmdQueueMsg, 1> pending; // Play and Stop supersede each other
+  g_pacer.begin(events);
 
-  for (;;)
+  // Drain any pending commands quickly (non-blocking), keeping only the
+  // latest one so a burst costs at most one animation restart.
+  while (RecvLightQueue(msg))
   {
-    // Drain any pending commands quickly (non-blocking)
-    while (xQueueReceive(queueBus.lightCmdQueueHandle, &msg, 0) == pdPASS)
-    {
-      // io_printf("[Light] Cmd=%u param=%u\n", (unsigned)msg.cmd, (unsigned)msg.param);
+    pending.add(0, msg);
+  }
+  while (pending.next(msg))
+  {
+    // io_printf("[Light] Cmd=%u param=%u\n", (unsigned)msg.cmd, (unsigned)msg.param);
 
-      // Process the incoming command.
-      switch (msg.cmd)
+    // Process the incoming command.
+    switch (msg.cmd)
+    {
+    case LightQueueCmd::Play:
+    {
+      if (msg.param >= NUM_LIGHT_ANIMATIONS)
       {
-      case LightQueueCmd::Play:
+        io_printf("Invalid light animation index: %d\n", msg.param);
+      }
+      else
       {
-        if (msg.param >= NUM_LIGHT_ANIMATIONS)
+        const StepParams look = step_params_merge(kLookDefaults[msg.param], msg.params);
+        if (!g_playing || msg.param != g_animIndex || memcmp(&look, &g_params, sizeof(look)) != 0)
         {
-          io_printf("Invalid light animation index: %d\n", msg.param);
+          // Start a new light animation (or the same one with a new look).
+          g_animIndex = msg.param;
+          g_params = look;
+          g_animReset = true;
+          FastLED.setBrightness(g_params.brightness ? g_params.brightness : g_brightness);
         }
         else
         {
-          if (!g_playing || msg.param != g_animIndex)
-          {
-            // Start a new light animation.
-            g_animIndex = msg.param;
-            g_animReset = true;
-          }
-          g_playing = true;
+          // Already showing exactly this.
+          queue_stats_coalesced(BusQueue::Light, 1);
         }
-        break;
-      }
-
-      case LightQueueCmd::Stop:
-      {
-        g_playing = false;
-        g_animReset = true; // ensure clean start next time
-        fill_solid(g_leds, NUM_LEDS, CRGB::Black);
-        FastLED.show();
-        break;
-      }
-
-      default:
-        // Ignore other commands for now
-        break;
+        g_playing = true;
       }
+      break;
     }
 
-    // Render one frame if playing
-    if (g_playing)
+    case LightQueueCmd::Stop:
     {
-      if (g_animIndex < NUM_LIGHT_ANIMATIONS)
-      {
-        // Call the selected animation function.
-        kAnims[g_animIndex](g_animReset);
-        g_animReset = false;
-      }
-      else
-      {
-        // Safety: if index invalid, just clear
-        fill_solid(g_leds, NUM_LEDS, CRGB::Black);
-      }
+      g_playing = false;
+      g_animReset = true; // ensure clean start next time
+      fill_solid(g_leds, NUM_LEDS, CRGB::Black);
       FastLED.show();
+      break;
     }
 
-    // Frame pacing
-    vTaskDelayUntil(&lastWake, frameTicks);
+    default:
+      // Ignore other commands for now
+      break;
+    }
   }
+  queue_stats_coalesced(BusQueue::Light, pending.takeEliminated());
+
+  // Render one frame if playing.  Static looks only need their first frame.
+  if (g_playing && (g_animReset || !kStaticAnim[g_animIndex]))
+  {
+    if (g_animIndex < NUM_LIGHT_ANIMATIONS)
+    {
+      // Call the selected animation function.
+      kAnims[g_animIndex](g_animReset);
+      g_animReset = false;
+    }
+    else
+    {
+      // Safety: if index invalid, just clear
+      fill_solid(g_leds, NUM_LEDS, CRGB::Black);
+    }
+    FastLED.show();
+  }
+
+  // Frame pacing.  Any notification (command or frame sync) ends the wait
+  // early and restarts the frame cadence from that moment.  With nothing
+  // moving on the strip we block until the next command.
+  return g_pacer.next(g_playing && !kStaticAnim[g_animIndex]);
+}
+
+static FrameJob g_lightJob = { "light", light_job_init, light_job_step,
+                              bus_evt_cmd(BusQueue::Light) | BUS_EVT_SYNC };
+
+void light_frame_sync()
+{
+  bus_notify(g_lightTask, BUS_EVT_SYNC);
 }
 
 // ---------- Init/start ----------
@@ -349,15 +378,23 @@ static bool light_hw_init_once()
   return true;
 }
 
-bool light_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core)
+bool light_start(StripModel model)
 {
+  if (model == StripModel::NONE)
+  {
+    return false;
+  }
+  if (model != STRIP_MODEL_BUILD)
+  {
+    // The LED driver and effect buffers are sized at compile time.
+    io_printf("[Light] Profile strip %s does not match build strip %s, using build strip.\n",
+              STRIP_MODEL_NAMES[static_cast<uint8_t>(model)],
+              STRIP_MODEL_NAMES[static_cast<uint8_t>(STRIP_MODEL_BUILD)]);
+  }
 
   // Initialize the hardware interface
   if (!light_hw_init_once())
     return false;
 
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      LightTask, "LightTask", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+  return frame_job_start(g_lightJob, TaskId::Light);
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <Arduino.h>
+#include "CommandCoalescer.h"
 #include "CommandQueues.h"
+#include "FrameJob.h"
 #include "Faults.h"
 #include "IoSync.h"
 #include "Logging.h"
@@ -36,6 +38,7 @@ SmoothServos servos(NUM_SERVOS);
 static bool g_playing = false;
 static uint8_t g_animIndex = static_cast<uint8_t>(MotorAnim::HOME);
 static bool g_animReset = true; // set true on animation change
+static StepParams g_params{};   // step parameters of the playing animation
 
 static float HOME_ANGLE = 90.0;
 static float LEFT_ANGLE = 0.0;
@@ -43,9 +46,44 @@ static float RIGHT_ANGLE = 180.0;
 
 static uint16_t g_targetFps = 50;
 
+// Outputs fitted on this node, from the node profile.
+static bool g_hasServo = true;
+static bool g_hasDiscrete = true;
+
 // ---------- Helpers ----------
 static inline uint32_t now_ms() { return (uint32_t)(esp_timer_get_time() / 1000ULL); }
 
+// Command the PWM servo output, if fitted.  A non-zero speed ramps the move
+// on boards whose servo library supports it.
+static void servo_write(float angle, double speed = 0, double ke = 0)
+{
+  if (!g_hasServo)
+  {
+    return;
+  }
+#if defined(ESP32C3_BOARD)  
+  if (speed > 0)
+  {
+    myservo.write(SERVO_1_PIN, angle, speed, ke);
+  }
+  else
+  {
+    myservo.write(SERVO_1_PIN, angle);
+  }
+#elif defined(ESP32C6_BOARD)
+  servos.snapTo(0, angle);
+#endif
+}
+
+// Switch the discrete motor output, if fitted.
+static void discrete_write(bool on)
+{
+  if (g_hasDiscrete)
+  {
+    digitalWrite(SERVO_2_PIN, on ? HIGH : LOW);
+  }
+}
+
 // Jiggle animation pattern
 static constexpr uint16_t NUM_JIGGLE_STEPS = 8;
 static constexpr float jiggle_positions[NUM_JIGGLE_STEPS] = {90.0, 100.0, 110.0, 100.0, 90.0, 80.0, 70.0, 80.0};
@@ -61,6 +99,9 @@ static constexpr uint32_t hammer_delays[NUM_HAMMER_STEPS] = {500, 500, 500, 500}
 // Setup any motor outputs that are true PWM servos.
 //
 bool config_servos() {
+  if (!g_hasServo) {
+    return true;
+  }
 #if defined(ESP32C6_BOARD)
   ServoConfig cfgs[NUM_SERVOS];
   cfgs[0] = {
@@ -99,6 +140,9 @@ return true;
 // Setup any motor outputs that are disctete outputs.
 //
 bool config_discrete_motors() {
+  if (!g_hasDiscrete) {
+    return true;
+  }
   pinMode(SERVO_2_PIN, OUTPUT);
   digitalWrite(SERVO_2_PIN, LOW); // Default is low/off.
   return true;
@@ -109,16 +153,10 @@ bool config_discrete_motors() {
 void motor_idle()
 {
   // Update the servo based motor outputs.
-#if defined(ESP32C3_BOARD)  
-  myservo.write(SERVO_1_PIN, HOME_ANGLE);
-  //myservo.write(SERVO_1_PIN, HOME_ANGLE);  // Replaced with discrete output!
-#elif defined(ESP32C6_BOARD)
-  servos.snapTo(0, HOME_ANGLE);
-  //servos.snapTo(1, HOME_ANGLE);  // Replaced with discrete output!
-#endif
+  servo_write(HOME_ANGLE);
 
   // Update the discrete motor outputs.
-  digitalWrite(SERVO_2_PIN, LOW); // Turn off motor.
+  discrete_write(false); // Turn off motor.
 }
 
 // Motor animation routine to home
@@ -138,16 +176,10 @@ static void anim_motor_home(bool reset)
   const uint32_t t = now_ms() - t0;
 
   // TODO: Ramp positions to home position
-#if defined(ESP32C3_BOARD)  
-  myservo.write(SERVO_1_PIN, HOME_ANGLE, speed, ke);
-  //myservo.write(SERVO_2_PIN, HOME_ANGLE, speed, ke);  // Replaced with discrete output!
-#elif defined(ESP32C6_BOARD)
-  servos.snapTo(0, HOME_ANGLE);
-  //servos.snapTo(1, HOME_ANGLE);  // Replaced with discrete output!
-#endif
+  servo_write(HOME_ANGLE, speed, ke);
 
   // Update the discrete motor outputs.
-  digitalWrite(SERVO_2_PIN, LOW); // Turn off motor.
+  discrete_write(false); // Turn off motor.
 
 }
 
@@ -175,13 +207,7 @@ static void anim_motor_jiggle(bool reset)
   }
 
   // Update the servos often to support the ramping in between changes.
-#if defined(ESP32C3_BOARD)  
-  myservo.write(SERVO_1_PIN, jiggle_positions[index], speed, ke);
-  //myservo.write(SERVO_2_PIN, jiggle_positions[index], speed, ke);  // Replaced with discrete output!
-#elif defined(ESP32C6_BOARD)
-  servos.snapTo(0, jiggle_positions[index]);
-  //servos.snapTo(1, jiggle_positions[index]);  // Replaced with discrete output!
-#endif
+  servo_write(jiggle_positions[index], speed, ke);
 
   if (!in_delay)
   {
@@ -191,7 +217,9 @@ static void anim_motor_jiggle(bool reset)
   else
   {
     uint32_t delta_msec = now_ms() - last_update_time;
-    if (delta_msec >= jiggle_delays[index])
+    // A step speed overrides the pattern's dwell at each position.
+    const uint32_t dwell = g_params.speedMs ? g_params.speedMs : jiggle_delays[index];
+    if (delta_msec >= dwell)
     {
       index++;
       in_delay = false;
@@ -199,7 +227,7 @@ static void anim_motor_jiggle(bool reset)
   }
 
   // Update the discrete motor outputs.
-  digitalWrite(SERVO_2_PIN, HIGH); // Turn on motor.
+  discrete_write(true); // Turn on motor.
 
 }
 
@@ -227,13 +255,7 @@ static void anim_motor_hammer(bool reset)
   }
 
   // Update the servos often to support the ramping in between changes.
-#if defined(ESP32C3_BOARD)  
-  myservo.write(SERVO_1_PIN, hammer_positions[index], speed, ke);
-  //myservo.write(SERVO_2_PIN, hammer_positions[index], speed, ke); // Replaced with discrete output!
-#elif defined(ESP32C6_BOARD)
-  servos.snapTo(0, hammer_positions[index]);
-  //servos.snapTo(1, hammer_positions[index]);   // Replaced with discrete output!
-#endif
+  servo_write(hammer_positions[index], speed, ke);
 
   if (!in_delay)
   {
@@ -243,7 +265,8 @@ static void anim_motor_hammer(bool reset)
   else
   {
     uint32_t delta_msec = now_ms() - last_update_time;
-    if (delta_msec >= hammer_delays[index])
+    const uint32_t dwell = g_params.speedMs ? g_params.speedMs : hammer_delays[index];
+    if (delta_msec >= dwell)
     {
       index++;
       in_delay = false;
@@ -251,7 +274,7 @@ static void anim_motor_hammer(bool reset)
   }
 
   // Update the discrete motor outputs.
-  digitalWrite(SERVO_2_PIN, HIGH); // Turn on motor.
+  discrete_write(true); // Turn on motor.
 
 }
 
@@ -259,11 +282,17 @@ static void anim_motor_hammer(bool reset)
 typedef void (*AnimFn)(bool reset);
 static AnimFn kAnims[NUM_MOTOR_ANIMATIONS] = {anim_motor_home, anim_motor_jiggle, anim_motor_hammer};
 
-static void MotorTask(void *)
+// Animations that hold still after their first frame (HOME snaps to home on
+// reset), so the task can sleep until the next command.
+static const bool kStaticAnim[NUM_MOTOR_ANIMATIONS] = {true, false, false};
+
+// Motor frame job (see FrameJob.h)
+//
+static FramePacer g_pacer(0);  // Frame length set from g_targetFps at init
+
+static void motor_job_init()
 {
-  MotorCmdQueueMsg msg{};
-  const TickType_t frameTicks = pdMS_TO_TICKS(1000UL / g_targetFps);
-  TickType_t lastWake = xTaskGetTickCount();
+  g_pacer.frameTicks = pdMS_TO_TICKS(1000UL / g_targetFps);
   bool servo_1_usable = true;
 
   if (!config_servos())
@@ -279,83 +308,102 @@ static void MotorTask(void *)
 
   io_printf("MOTOR - Seeded default PWM values.\n");
 
-  for (;;)
+  queueBus.motorCmdConsumer = xTaskGetCurrentTaskHandle();
+}
+
+static TickType_t motor_job_step(uint32_t events)
+{
+  MotorCmdQueueMsg msg{};
+  CommandCoalescer<MotorCmdQueueMsg, 1> pending; // Play/Stop/Home supersede each other
+  g_pacer.begin(events);
+
+  // Only the latest of a burst of commands reaches the motors.
+  while (RecvMotorQueue(msg))
   {
+    pending.add(0, msg);
+  }
+  while (pending.next(msg))
+  {
+    io_printf("Received incoming motor command: %d, param: %d\n", msg.cmd, msg.param);
 
-    if (xQueueReceive(queueBus.motorCmdQueueHandle, &msg, 0) == pdPASS)
+    // Process the incoming command.
+    switch (msg.cmd)
     {
-      io_printf("Received incoming motor command: %d, param: %d\n", msg.cmd, msg.param);
-
-      // Process the incoming command.
-      switch (msg.cmd)
+    case MotorQueueCmd::Play:
+    {
+      if (msg.param >= NUM_MOTOR_ANIMATIONS)
       {
-      case MotorQueueCmd::Play:
+        io_printf("Invalid motor animation index: %d\n", msg.param);
+      }
+      else
       {
-        if (msg.param >= NUM_MOTOR_ANIMATIONS)
+        if (!g_playing || msg.param != g_animIndex ||
+            memcmp(&msg.params, &g_params, sizeof(g_params)) != 0)
         {
-          io_printf("Invalid motor animation index: %d\n", msg.param);
+          // Start a new motor animation (or the same one with new params).
+          g_animIndex = msg.param;
+          g_params = msg.params;
+          g_animReset = true;
         }
         else
         {
-          if (!g_playing || msg.param != g_animIndex)
-          {
-            // Start a new motor animation.
-            g_animIndex = msg.param;
-            g_animReset = true;
-          }
-          g_playing = true;
+          // Already running exactly this.
+          queue_stats_coalesced(BusQueue::Motor, 1);
         }
-        break;
+        g_playing = true;
       }
+      break;
+    }
 
-      case MotorQueueCmd::Stop:
-      {
-        g_playing = false;
-        g_animReset = true; // ensure clean start next time
+    case MotorQueueCmd::Stop:
+    {
+      g_playing = false;
+      g_animReset = true; // ensure clean start next time
 
-#if defined(ESP32C3_BOARD)  
-        myservo.write(SERVO_1_PIN, HOME_ANGLE);
-        //myservo.write(SERVO_1_PIN, HOME_ANGLE);  // Replaced with discrete output!
-#elif defined(ESP32C6_BOARD)
-        servos.snapTo(0, HOME_ANGLE);
-        //servos.snapTo(1, HOME_ANGLE);  // Replaced with discrete output!
-#endif
-        break;
-      }
+      servo_write(HOME_ANGLE);
+      break;
+    }
 
-      default:
-        // Ignore other commands for now
-        break;
-      }
+    default:
+      // Ignore other commands for now
+      break;
     }
+  }
+  queue_stats_coalesced(BusQueue::Motor, pending.takeEliminated());
 
-    // Execute the last requested motor animation if playing.
-    if (g_playing)
+  // Execute the last requested motor animation if playing.
+  if (g_playing && (g_animReset || !kStaticAnim[g_animIndex]))
+  {
+    if (g_animIndex < NUM_MOTOR_ANIMATIONS)
     {
-      if (g_animIndex < NUM_MOTOR_ANIMATIONS)
-      {
-        // Call the selected animation function.
-        kAnims[g_animIndex](g_animReset);
-        g_animReset = false;
-      }
-      else
-      {
-        // Safety: if index invalid, just clear
-        motor_idle();
-      }
+      // Call the selected animation function.
+      kAnims[g_animIndex](g_animReset);
+      g_animReset = false;
+    }
+    else
+    {
+      // Safety: if index invalid, just clear
+      motor_idle();
     }
-
-    // Frame pacing
-    vTaskDelayUntil(&lastWake, frameTicks);
   }
+
+  // Frame pacing.  Only a moving pattern needs the frame timer, otherwise
+  // block until the next command.
+  return g_pacer.next(g_playing && !kStaticAnim[g_animIndex]);
 }
 
+static FrameJob g_motorJob = { "motor", motor_job_init, motor_job_step, bus_evt_cmd(BusQueue::Motor) };
+
 
 
-bool motor_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core)
+bool motor_start(MotorType type)
 {
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      MotorTask, "MotorTask", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+  if (type == MotorType::NONE || type >= MotorType::COUNT)
+  {
+    return false;
+  }
+  g_hasServo = (type == MotorType::SERVO || type == MotorType::BOTH);
+  g_hasDiscrete = (type == MotorType::DISCRETE || type == MotorType::BOTH);
+
+  return frame_job_start(g_motorJob, TaskId::Motor);
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <atomic>
+#include "PeerTable.h"
+#include "IoSync.h"
+
+// A forward jump in seq bigger than this is a restart, not lost frames.
+// Backwards jumps within the duplicate window are late frames; further
+// back is a restart.
+static constexpr uint16_t MAX_SEQ_GAP = 1000;
+
+// Transit changes are clamped so a fleet clock step does not swamp jitter.
+static constexpr uint32_t MAX_JITTER_MS = 1000;
+
+struct PeerSlot {
+  std::atomic<uint32_t> guard{0};   // Odd while the writer is updating
+  PeerInfo info;
+  // Writer-only state, not part of the published copy.
+  uint16_t lastSeq = 0;
+  int32_t  lastTransitMs = 0;
+  bool     haveSeq = false;
+};
+
+static PeerSlot g_peers[PEER_MAX_NODES];
+
+// ---- Writer ----
+static inline void write_begin(PeerSlot& s) {
+  s.guard.store(s.guard.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+static inline void write_end(PeerSlot& s) {
+  s.guard.store(s.guard.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Fold n lost (or received) frames into the smoothed loss fraction.
+static inline void note_loss(PeerInfo& p, uint32_t lost, uint32_t received) {
+  for (uint32_t i = 0; i < lost && i < 64; i++) p.lossQ16 += (65535 - p.lossQ16) >> 4;
+  for (uint32_t i = 0; i < received; i++) p.lossQ16 -= p.lossQ16 >> 4;
+}
+
+void peer_table_heard(const Proto::Header& hdr, uint32_t rxLocalMs) {
+  if (hdr.src >= PEER_MAX_NODES) return;
+  PeerSlot& s = g_peers[hdr.src];
+
+  write_begin(s);
+  PeerInfo& p = s.info;
+  p.lastSeenMs = rxLocalMs ? rxLocalMs : 1;
+  p.version = hdr.version;
+  if (hdr.version >= 2) {
+    const int32_t transit = (int32_t)(rxLocalMs - hdr.sentMs);
+    const int16_t gap = (int16_t)(hdr.seq - s.lastSeq);
+    if (s.haveSeq && gap <= 0 && gap > -(int16_t)Proto::DUP_WINDOW) {
+      // Late, out of order: it was counted lost when the gap opened.
+      p.received++;
+      if (p.lost) p.lost--;
+      write_end(s);
+      return;
+    }
+    if (!s.haveSeq || gap <= 0 || gap > (int16_t)MAX_SEQ_GAP) {
+      // First frame, or the sender restarted its sequence.
+      if (s.haveSeq) p.restarts++;
+      p.received = 1;
+      p.lost = 0;
+      note_loss(p, 0, 1);
+    } else {
+      p.received++;
+      p.lost += gap - 1;
+      note_loss(p, gap - 1, 1);
+      const int32_t d = transit - s.lastTransitMs;
+      const uint32_t absD = (uint32_t)(d < 0 ? -d : d);
+      const uint32_t absDX16 = (absD < MAX_JITTER_MS ? absD : MAX_JITTER_MS) * 16;
+      p.jitterMsX16 += (int32_t)(absDX16 - p.jitterMsX16) / 16;
+    }
+    s.lastSeq = hdr.seq;
+    s.lastTransitMs = transit;
+    s.haveSeq = true;
+  } else {
+    p.received++;
+  }
+  write_end(s);
+}
+
+void peer_table_ping(uint8_t id, int8_t rssi, uint16_t rangeMm) {
+  if (id >= PEER_MAX_NODES) return;
+  PeerSlot& s = g_peers[id];
+  write_begin(s);
+  s.info.rssi = rssi;
+  s.info.rangeMm = rangeMm;
+  write_end(s);
+}
+
+// ---- Readers ----
+bool peer_table_get(uint8_t id, PeerInfo& out) {
+  if (id >= PEER_MAX_NODES) return false;
+  PeerSlot& s = g_peers[id];
+  uint32_t before, after;
+  do {
+    before = s.guard.load(std::memory_order_acquire);
+    out = s.info;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = s.guard.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+  return out.lastSeenMs != 0;
+}
+
+uint8_t peer_table_alive() {
+  const uint32_t now = millis();
+  uint8_t n = 0;
+  PeerInfo p;
+  for (uint8_t id = 0; id < PEER_MAX_NODES; id++) {
+    if (peer_table_get(id, p) && now - p.lastSeenMs <= PEER_ALIVE_MS) n++;
+  }
+  return n;
+}
+
+void peer_table_print() {
+  const uint32_t now = millis();
+  io_printf(" id  ver   age ms  rssi  range mm   recv   lost  loss%%  jitter ms  restarts\n");
+  PeerInfo p;
+  uint8_t shown = 0;
+  for (uint8_t id = 0; id < PEER_MAX_NODES; id++) {
+    if (!peer_table_get(id, p)) continue;
+    const uint32_t age = now - p.lastSeenMs;
+    const uint32_t lossX10 = ((uint32_t)p.lossQ16 * 1000) >> 16;
+    const uint32_t jitX10 = (uint32_t)p.jitterMsX16 * 10 / 16;
+    io_printf(" %2u  v%u  %7lu%s %5d  %8u  %5lu  %5lu  %3lu.%lu  %7lu.%lu  %8lu\n",
+              id, p.version, (unsigned long)age, age > PEER_ALIVE_MS ? "!" : " ",
+              p.rssi, p.rangeMm, (unsigned long)p.received, (unsigned long)p.lost,
+              (unsigned long)(lossX10 / 10), (unsigned long)(lossX10 % 10),
+              (unsigned long)(jitX10 / 10), (unsigned long)(jitX10 % 10),
+              (unsigned long)p.restarts);
+    shown++;
+  }
+  if (!shown) io_printf(" (no peers heard)\n");
+  io_printf(" %u alive (! = silent over %lu ms)\n", peer_table_alive(), (unsigned long)PEER_ALIVE_MS);
+}
@@ -0,0 +1,85 @@
+#include "Protocol.h"
+#include "IoSync.h"
+
+// ---- Schema benchmark ----
+// The handlers only fold the decoded fields into a sum so the compiler
+// cannot drop the decode.
+namespace {
+
+struct BenchSink {
+  uint32_t sum = 0;
+};
+
+struct BenchHandlers {
+  static void on(const Proto::PingMsg& m, const Proto::View&, BenchSink& s) {
+    s.sum += m.rssi + m.rangeMm + m.fleetMs + m.queueDrops + m.queueFillPct;
+  }
+  static void on(const Proto::ChangeModeMsg& m, const Proto::View&, BenchSink& s) {
+    s.sum += m.mode;
+  }
+  static void on(const Proto::TriggerAnimMsg& m, const Proto::View&, BenchSink& s) {
+    s.sum += m.animId + m.startAtMs + m.waveStepMs;
+  }
+  static void on(const Proto::TimeReqMsg& m, const Proto::View&, BenchSink& s) {
+    s.sum += (uint32_t)m.t1;
+  }
+  static void on(const Proto::TimeRespMsg& m, const Proto::View&, BenchSink& s) {
+    s.sum += (uint32_t)(m.t1 + m.t2 + m.t3);
+  }
+};
+
+typedef Proto::Dispatcher<BenchHandlers, BenchSink> BenchDispatch;
+
+struct BenchFrame {
+  uint8_t buf[Proto::HDR_SIZE + 32];
+  size_t  len;
+};
+
+} // namespace
+
+void proto_benchmark(uint32_t iterations) {
+  if (iterations == 0) iterations = 1;
+
+  Proto::PingMsg ping;
+  ping.rssi = -61; ping.rangeMm = 240; ping.fleetMs = 123456; ping.queueDrops = 2; ping.queueFillPct = 40;
+  Proto::ChangeModeMsg mode;
+  mode.mode = 3;
+  Proto::TriggerAnimMsg trig;
+  trig.animId = 7; trig.startAtMs = 987654; trig.waveStepMs = 150;
+  Proto::TimeReqMsg req;
+  req.t1 = 1111111;
+  Proto::TimeRespMsg resp;
+  resp.t1 = 1111111; resp.t2 = 2222222; resp.t3 = 2222300;
+
+  static BenchFrame frames[5];
+  static constexpr uint32_t NUM_FRAMES = sizeof(frames) / sizeof(frames[0]);
+
+  uint32_t start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < iterations; i++) {
+    ping.fleetMs = i;
+    frames[0].len = Proto::encode(frames[0].buf, sizeof(frames[0].buf), 1, 2, ping);
+    frames[1].len = Proto::encode(frames[1].buf, sizeof(frames[1].buf), 1, 2, mode);
+    frames[2].len = Proto::encode(frames[2].buf, sizeof(frames[2].buf), 1, 2, trig);
+    frames[3].len = Proto::encode(frames[3].buf, sizeof(frames[3].buf), 1, 2, req);
+    frames[4].len = Proto::encode(frames[4].buf, sizeof(frames[4].buf), 1, 2, resp);
+  }
+  const uint32_t encodeCycles = ESP.getCycleCount() - start;
+
+  BenchSink sink;
+  uint32_t failed = 0;
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < iterations; i++) {
+    for (uint32_t f = 0; f < NUM_FRAMES; f++) {
+      Proto::View v;
+      if (!Proto::parse(frames[f].buf, frames[f].len, v) || !BenchDispatch::dispatch(v, sink)) failed++;
+    }
+  }
+  const uint32_t decodeCycles = ESP.getCycleCount() - start;
+
+  const uint32_t msgs = iterations * NUM_FRAMES;
+  io_printf("%lu rounds of %lu messages (check %lu, %lu failed):\n",
+            (unsigned long)iterations, (unsigned long)NUM_FRAMES,
+            (unsigned long)sink.sum, (unsigned long)failed);
+  io_printf("  Encode:          %lu cycles/msg\n", (unsigned long)(encodeCycles / msgs));
+  io_printf("  Parse+dispatch:  %lu cycles/msg\n", (unsigned long)(decodeCycles / msgs));
+}
@@ -1,12 +1,14 @@
 //
 // Proximity Detector
 //
-// If wiring to a TOFSense-F2 Mini Lidar, add -DPROX_TYPE_LIDAR to the platformio.ini build flags.
-// If wiring to a PIR AM312 sensor, add -DPROX_TYPE_PIR to the platformio.ini build flags.
+// The sensor in use comes from the node profile (cfg set prox lidar|pir).
+// Nodes without a saved profile fall back to the build flag default:
+// -DPROX_TYPE_LIDAR for a TOFSense-F2 Mini Lidar, -DPROX_TYPE_PIR for a PIR AM312.
 //
 #include <Arduino.h>
 
 #include "CommandQueues.h"
+#include "FrameJob.h"
 #include "Faults.h"
 #include "IoSync.h"
 #include "Logging.h"
@@ -30,17 +32,18 @@ enum class DetectState : uint8_t
 DetectState detectState = DetectState::UNKNOWN;
 
 
-#if defined PROX_TYPE_LIDAR
 #include <Wire.h> // I2C drivers
 
+// Sensor selected at start from the node profile.
+static ProxType g_proxType = ProxType::NONE;
+
+// ---------- TOFSense-F2 Mini Lidar ----------
+
 // I2C Device address for the sensor.
 // The address is a combination of the base address + programmable device ID.
 // This allows multiple sensors to be wired to the same I2C bus.
 #define deviceaddress 0x08
 
-
-
-
 bool sensor_online = false;
 float sensor_distance = MAX_RANGE;
 float range_mm = MAX_RANGE;
@@ -51,8 +54,6 @@ float range_mm = MAX_RANGE;
 static constexpr uint16_t DETECT_HYST_MIN_MM = 750;      /* Must be closer than this for "close". */
 static constexpr uint16_t DETECT_HYST_MAX_MM = 1000;     /* Must be farther than this for "far". */
 
-
-
 //
 // Example code sourced from: https://wiki.dfrobot.com/SKU_SEN0646_TOF_laser_ranging_sensor_7.8m#Arduino%20Sample%20Code
 //
@@ -104,21 +105,8 @@ bool recJustDistance()
   return true;
 }
 
-// Return the last processed reading.
-float prox_range()
-{
-  return range_mm;
-}
-
-// Main proximity detection task.
-static void ProxDetectTask(void *)
+void init_lidar_sensor()
 {
-
-  uint16_t range_close_count = 0;
-  uint16_t range_far_count = 0;
-
-  io_printf("[Prox] Task starting...\n");
-
   // Configure the I2C bus pins for DATA and CLOCK.
   sensor_online = Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, 400000);
 
@@ -126,102 +114,36 @@ static void ProxDetectTask(void *)
     FAULT_SET(FAULT_TOF_SENSOR_INIT_FAIL);
     io_printf("Failed to detect and initialize TOF sensor!\n");
   }
+}
 
-  // Framerate control
-  const TickType_t frameTicks = pdMS_TO_TICKS(1000UL / DETECTION_FPS);
-  TickType_t lastWake = xTaskGetTickCount();
-
-  for (;;)
+// Take one lidar reading and classify it as close and/or far.
+void read_lidar_sensor(bool &close, bool &far)
+{
+  // For speed, read just the distance.
+  if (recJustDistance())
   {
-    if (sensor_online)
-    {
-
-      // For speed, read just the distance.
-      if (recJustDistance())
-      {
-        if (sensor_distance < 0.01) {
-          // Did not detect anyything, assume max range in this case.
-          range_mm = MAX_RANGE;
-        }
-        else 
-        {
-          range_mm = sensor_distance;
-        }
-      }
-      else 
-      {
+    if (sensor_distance < 0.01) {
+      // Did not detect anyything, assume max range in this case.
       range_mm = MAX_RANGE;
-      }
-
-      //io_printf("mm: %f\n", range_mm);
-
-      // Filter range reading to one of three zones, far, near or in between.
-      if (range_mm <= DETECT_HYST_MIN_MM)
-      {
-        if (range_close_count < RANGE_CONSEQ_COUNT_MAX)
-        {
-          range_close_count++;
-        }
-        range_far_count = 0;
-      }
-      else if (range_mm >= DETECT_HYST_MAX_MM)
-      {
-        range_close_count = 0;
-        if (range_far_count < RANGE_CONSEQ_COUNT_MAX)
-        {
-          range_far_count++;
-        }
-      }
-      else
-      {
-        range_close_count = 0;
-        range_far_count = 0;
-      }
-
-      // Detect changes in detected zones.
-      switch (detectState)
-      {
-      case DetectState::UNKNOWN:
-        // Must start with clear detection area on start.
-        if (range_far_count >= DETECT_MIN_FAR_READINGS)
-        {
-          detectState = DetectState::FAR;
-        }
-        break;
-
-      case DetectState::FAR:
-        if (range_close_count >= DETECT_MIN_CLOSE_READINGS)
-        {
-          // Far to close detect event occurred!
-          detectState = DetectState::CLOSE;
-
-          // Queue up an event indicating a local station proximity trigger.
-          SendShowQueue(ShowInputQueueMsg{ShowInputQueueCmd::TriggerLocal, 0});
-        }
-        break;
-
-      case DetectState::CLOSE:
-        if (range_far_count >= DETECT_MIN_FAR_READINGS)
-        {
-          // Close to far detect event occurred!
-          detectState = DetectState::FAR;
-        }
-
-        break;
-      }
     }
-
-    // Frame pacing
-    vTaskDelayUntil(&lastWake, frameTicks);
+    else 
+    {
+      range_mm = sensor_distance;
+    }
+  }
+  else 
+  {
+  range_mm = MAX_RANGE;
   }
-}
-
-
 
-#endif
+  //io_printf("mm: %f\n", range_mm);
 
+  // Readings in between the thresholds are neither close nor far.
+  close = (range_mm <= DETECT_HYST_MIN_MM);
+  far = (range_mm >= DETECT_HYST_MAX_MM);
+}
 
-#if defined PROX_TYPE_PIR
+// ---------- AM312 PIR ----------
 
 void init_pir_sensor() 
 {
@@ -241,100 +163,156 @@ bool is_pir_detected()
   }
 }
 
+// ---------- Common ----------
+
 // Return the last processed reading.
 float prox_range()
 {
-  // Creating a pseudo reading using the PIR switch input.
-  if (is_pir_detected())
+  switch (g_proxType)
   {
-    return 10.0;
-  }
-  else{
+  case ProxType::LIDAR:
+    return range_mm;
+
+  case ProxType::PIR:
+    // Creating a pseudo reading using the PIR switch input.
+    return is_pir_detected() ? 10.0 : MAX_RANGE;
+
+  default:
     return MAX_RANGE;
   }
 }
 
-// Main proximity detection task.
-static void ProxDetectTask(void *)
+// Filter readings to one of three zones, far, near or in between, and
+// raise a local trigger on a debounced far to close transition.
+static void update_detect_state(bool close, bool far,
+                                uint16_t &range_close_count,
+                                uint16_t &range_far_count)
+{
+  if (close)
+  {
+    if (range_close_count < RANGE_CONSEQ_COUNT_MAX)
+    {
+      range_close_count++;
+    }
+    range_far_count = 0;
+  }
+  else if (far)
+  {
+    range_close_count = 0;
+    if (range_far_count < RANGE_CONSEQ_COUNT_MAX)
+    {
+      range_far_count++;
+    }
+  }
+  else
+  {
+    range_close_count = 0;
+    range_far_count = 0;
+  }
+
+  // Detect changes in detected zones.
+  switch (detectState)
+  {
+  case DetectState::UNKNOWN:
+    // Must start with clear detection area on start.
+    if (range_far_count >= DETECT_MIN_FAR_READINGS)
+    {
+      detectState = DetectState::FAR;
+    }
+    break;
+
+  case DetectState::FAR:
+    if (range_close_count >= DETECT_MIN_CLOSE_READINGS)
+    {
+      // Far to close detect event occurred!
+      detectState = DetectState::CLOSE;
+
+      // Queue up an event indicating a local station proximity trigger.
+      SendShowQueue(ShowInputQueueMsg{ShowInputQueueCmd::TriggerLocal, 0});
+    }
+    break;
+
+  case DetectState::CLOSE:
+    if (range_far_count >= DETECT_MIN_FAR_READINGS)
+    {
+      // Close to far detect event occurred!
+      detectState = DetectState::FAR;
+    }
+
+    break;
+  }
+}
+
+// Proximity detection frame job (see FrameJob.h)
+static uint16_t g_rangeCloseCount = 0;
+static uint16_t g_rangeFarCount = 0;
+static TickType_t g_frameTicks = 0;
+static TickType_t g_lastWake = 0;
+
+static void prox_job_init()
 {
-  uint16_t range_close_count = 0;
-  uint16_t range_far_count = 0;
-  bool detected = false;
+  io_printf("[Prox] Task starting in %s mode...\n", PROX_TYPE_NAMES[static_cast<uint8_t>(g_proxType)]);
 
-  io_printf("[Prox] Task starting in PIR mode...\n");
-  init_pir_sensor();
+  if (g_proxType == ProxType::LIDAR)
+  {
+    init_lidar_sensor();
+  }
+  else
+  {
+    init_pir_sensor();
+  }
+
+  // Local triggers go to the show over the lock-free fast path.
+  queueBus.showInputProducer = xTaskGetCurrentTaskHandle();
 
   // Framerate control
-  const TickType_t frameTicks = pdMS_TO_TICKS(1000UL / DETECTION_FPS);
-  TickType_t lastWake = xTaskGetTickCount();
+  g_frameTicks = pdMS_TO_TICKS(1000UL / DETECTION_FPS);
+  g_lastWake = xTaskGetTickCount();
+}
 
-  for (;;)
+static TickType_t prox_job_step(uint32_t)
+{
+  bool close = false;
+  bool far = false;
+
+  if (g_proxType == ProxType::LIDAR)
   {
-  
-      detected = is_pir_detected();
-      //io_printf("PIR detected: %d\n", detected);
-
-      // Filter range reading to one of three zones, far, near or in between.
-      if (detected)
-      {
-        if (range_close_count < RANGE_CONSEQ_COUNT_MAX)
-        {
-          range_close_count++;
-        }
-        range_far_count = 0;
-      }
-      else
-      {
-        range_close_count = 0;
-        if (range_far_count < RANGE_CONSEQ_COUNT_MAX)
-        {
-          range_far_count++;
-        }
-      }
-
-      // Detect changes in detected zones.
-      switch (detectState)
-      {
-      case DetectState::UNKNOWN:
-        // Must start with clear detection area on start.
-        if (range_far_count >= DETECT_MIN_FAR_READINGS)
-        {
-          detectState = DetectState::FAR;
-        }
-        break;
-
-      case DetectState::FAR:
-        if (range_close_count >= DETECT_MIN_CLOSE_READINGS)
-        {
-          // Far to close detect event occurred!
-          detectState = DetectState::CLOSE;
-
-          // Queue up an event indicating a local station proximity trigger.
-          SendShowQueue(ShowInputQueueMsg{ShowInputQueueCmd::TriggerLocal, 0});
-        }
-        break;
-
-      case DetectState::CLOSE:
-        if (range_far_count >= DETECT_MIN_FAR_READINGS)
-        {
-          // Close to far detect event occurred!
-          detectState = DetectState::FAR;
-        }
-
-        break;
-      }
-
-    // Frame pacing
-    vTaskDelayUntil(&lastWake, frameTicks);
+    if (sensor_online)
+    {
+      read_lidar_sensor(close, far);
+      update_detect_state(close, far, g_rangeCloseCount, g_rangeFarCount);
+    }
   }
+  else
+  {
+    close = is_pir_detected();
+    //io_printf("PIR detected: %d\n", close);
+    update_detect_state(close, !close, g_rangeCloseCount, g_rangeFarCount);
+  }
+
+  // Frame pacing.  Hold a fixed sample rate; if we fell behind, restart the
+  // cadence from now rather than bursting to catch up.
+  g_lastWake += g_frameTicks;
+  const TickType_t now = xTaskGetTickCount();
+  const int32_t remaining = (int32_t)(g_lastWake - now);
+  if (remaining > 0)
+  {
+    return (TickType_t)remaining;
+  }
+  g_lastWake = now;
+  return 0;
 }
-#endif
 
+static FrameJob g_proxJob = { "prox", prox_job_init, prox_job_step, 0 };
 
-bool prox_detect_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core)
+
+bool prox_detect_start(ProxType type)
 {
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      ProxDetectTask, "ProxDetectTask", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+  if (type == ProxType::NONE || type >= ProxType::COUNT)
+  {
+    return false;
+  }
+  g_proxType = type;
+
+  return frame_job_start(g_proxJob, TaskId::ProxDetect);
 }
\ No newline at end of file
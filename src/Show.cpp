@@ -3,9 +3,13 @@
 #include "Audio.h"
 #include "CommandQueues.h"
 #include "elapsedMillis.h"
+#include "FleetClock.h"
+#include "FrameJob.h"
+#include "IdlePlaylist.h"
 #include "Light.h"
 #include "main.h"
 #include "Motor.h"
+#include "PeerTable.h"
 #include "Show.h"
 
 #include "IoSync.h"
@@ -15,11 +19,27 @@
 
 
 // Animation Profiles
-const AnimationStep idleShow[] = {
-    { 22000, LightAnim::PORTAL_HALLOWEEN, AudioAnim::THERAMIN, MotorAnim::HOME},
-    { 30000, LightAnim::FLAMES, AudioAnim::FIRE, MotorAnim::HOME },
+
+// Idle playlist.  Each scene runs between its step duration and max ms and
+// is picked with the given relative weight.
+const IdleCandidate idleCandidates[] = {
+    { { 18000, LightAnim::PORTAL_HALLOWEEN, AudioAnim::THERAMIN, MotorAnim::HOME }, 26000, 4 },
+    { { 24000, LightAnim::FLAMES,           AudioAnim::FIRE,     MotorAnim::HOME }, 36000, 4 },
+    { { 15000, LightAnim::PORTAL_REDWHITE,  AudioAnim::THERAMIN, MotorAnim::HOME }, 20000, 1 },
+    { { 10000, LightAnim::BLANK,            AudioAnim::SILENCE,  MotorAnim::HOME }, 15000, 1 },
+    // Slow green/purple portal, a look made from parameters alone.
+    { { 15000, LightAnim::PORTAL_HALLOWEEN, AudioAnim::THERAMIN, MotorAnim::HOME,
+        { .flags = STEP_PARAM_COLORS, .colorA = {0, 200, 40}, .colorB = {120, 0, 160},
+          .bandWidth = 10, .speedMs = 140, .direction = -1, .cooling = 0, .sparking = 0,
+          .brightness = 0, .volume = 18 } }, 22000, 2 },
 };
-const uint8_t IDLE_SHOW_LENGTH = sizeof(idleShow) / sizeof(AnimationStep);
+const uint8_t IDLE_CANDIDATE_COUNT = sizeof(idleCandidates) / sizeof(IdleCandidate);
+
+// Never replay either of the last two idle scenes.
+static constexpr size_t IDLE_NO_REPEAT = 2;
+
+// Shared by every arch so they all draw the same idle sequence.
+static constexpr uint32_t IDLE_PLAYLIST_SEED = 0x41524348; // "ARCH"
 
 const AnimationStep localShow[] = {
     { 6000, LightAnim::LIGHTNING,   AudioAnim::THUNDER,  MotorAnim::JIGGLE },
@@ -35,92 +55,153 @@ const AnimationStep remoteShow[] = {
 };
 const uint8_t REMOTE_SHOW_LENGTH = sizeof(remoteShow) / sizeof(AnimationStep);
 
-#define START_IDLE_ANIM() do {currentShow = idleShow; currentShowLength = IDLE_SHOW_LENGTH;} while(0)
+// Idle loop for nodes whose profile sits out the idle show.
+const AnimationStep darkShow[] = {
+    { 30000, LightAnim::BLANK, AudioAnim::SILENCE, MotorAnim::HOME },
+};
+const uint8_t DARK_SHOW_LENGTH = sizeof(darkShow) / sizeof(AnimationStep);
+
+#define START_IDLE_ANIM() do { \
+    if (profile.playsShow(SHOW_MASK_IDLE)) { \
+      const uint8_t pick = idlePlaylist.next(fleet_time_ms(), idleStep); \
+      io_printf("Show idle scene %u for %lu ms\n", pick, (unsigned long)idleStep.duration_ms); \
+      currentShow = &idleStep; currentShowLength = 1;} \
+    else {currentShow = darkShow; currentShowLength = DARK_SHOW_LENGTH;} } while(0)
 #define START_LOCAL_ANIM() do {currentShow = localShow; currentShowLength = LOCAL_SHOW_LENGTH;} while(0)
 #define START_REMOTE_ANIM() do {currentShow = remoteShow; currentShowLength = REMOTE_SHOW_LENGTH;} while(0)
 
 // Minimum time between local triggers.
 #define MIN_LOCAL_TRIGGER_TURNAROUND_MSEC 10 * 1000
 
+// Lead time between sending a trigger and the fleet-wide start.  Must cover
+// the worst multicast delivery time so every peer sees it before it is due.
+static constexpr uint32_t TRIGGER_START_LEAD_MS = 80;
+
+// Scheduled starts further out than this are treated as bogus and start now.
+static constexpr uint32_t TRIGGER_START_MAX_AHEAD_MS = 2000;
+
+// Triggers go out as a burst of identical copies (see NetService.h) so one
+// lost datagram does not leave an arch dark.  Peers drop the extras by seq.
+static constexpr uint8_t TRIGGER_COPIES = 3;
+
+// Cap on the extra delay a wave trigger may add at the far end of the walkway.
+static constexpr uint32_t WAVE_MAX_DELAY_MS = 5000;
+
 // 
-bool send_trigger(uint8_t animId) {
-  // Trigger message has one data byte after header.
-  uint8_t frame[Proto::HDR_SIZE + 1];
-  size_t len = Proto::buildTriggerAnim(
-      frame,
-      sizeof(frame),
-      Proto::BROADCAST,                // send to all peers
-      settingsConfig.deviceId(),       // my node id as source
-      animId);
-  if (len == 0) {
-    ESP_LOGE("NET", "Failed to pack trigger message!");
-    return false;
-  }
-  ESP_LOGI("NET", "Sending TRIGGER_ANIM %u...", animId);
-  int sent = networkService->send(frame, len);
-  if (sent == (int)len) return true;
-  ESP_LOGE("NET", "Trigger send failed! rc=%d", sent);
+bool send_trigger(uint8_t animId, uint32_t startAtMs, uint16_t waveStepMs) {
+  // Queued for the net task, which builds the frame (anim id, fleet start
+  // time and wave step after the header) when it goes out.
+  ESP_LOGI("NET", "Sending TRIGGER_ANIM %u to %u live peers...", animId, peer_table_alive());
+  NetSendQueueMsg m{ Proto::BROADCAST, Proto::CMD_TRIGGER_ANIM, animId, TRIGGER_COPIES, waveStepMs, startAtMs };
+  if (networkService->post(m)) return true;
+  ESP_LOGE("NET", "Trigger send failed! TX queue full");
   return false;
 }
 
 
+// Extra delay before this node joins a wave that started at station origin.
+// Each walkway position away from the origin adds one wave step.
+static uint32_t wave_delay_ms(uint8_t origin, uint16_t waveStepMs) {
+  if (waveStepMs == 0) {
+    return 0;
+  }
+  const int myPos = settingsConfig.wavePosition(settingsConfig.deviceId());
+  const int originPos = settingsConfig.wavePosition(origin);
+  const uint32_t delay = (uint32_t)abs(myPos - originPos) * waveStepMs;
+  return (delay < WAVE_MAX_DELAY_MS) ? delay : WAVE_MAX_DELAY_MS;
+}
 
-static void ShowTask(void*) {
-  ShowStates showState = ShowStates::SHOWSTATE_START_TABLE;
-  uint32_t stepStartTime = 0;
-  uint8_t currentStep = 0;
-  const AnimationStep* currentShow = nullptr;
-  uint8_t currentShowLength = 0;
-  ShowInputQueueMsg in_msg{};
-  elapsedMillis time_since_last_local_trigger = 0; 
+// Show frame job (see FrameJob.h)
+static ShowStates showState = ShowStates::SHOWSTATE_START_TABLE;
+static uint32_t stepStartTime = 0;
+static uint8_t currentStep = 0;
+static const AnimationStep* currentShow = nullptr;
+static uint8_t currentShowLength = 0;
+static elapsedMillis time_since_last_local_trigger = 0;
+static uint32_t scheduledStart = 0;   // Fleet time to start the selected show
+static uint32_t scheduleHorizon = TRIGGER_START_MAX_AHEAD_MS; // Furthest sane start
+static NodeProfile profile{};
+static IdlePlaylist<IDLE_CANDIDATE_COUNT, IDLE_NO_REPEAT> idlePlaylist(idleCandidates, IDLE_PLAYLIST_SEED);
+static AnimationStep idleStep{};      // Scene most recently drawn from the idle playlist
+
+static void show_job_init() {
+  profile = settingsConfig.profile();
+
+  queueBus.showInputConsumer = xTaskGetCurrentTaskHandle();
+
+  // We are the only task feeding the subsystem queues during a show, so
+  // take their lock-free fast path.
+  queueBus.audioCmdProducer = xTaskGetCurrentTaskHandle();
+  queueBus.lightCmdProducer = xTaskGetCurrentTaskHandle();
+  queueBus.motorCmdProducer = xTaskGetCurrentTaskHandle();
+}
 
-  for (;;)
-  {
+static TickType_t show_job_step(uint32_t) {
+  ShowInputQueueMsg in_msg{};
 
-    if (xQueueReceive(queueBus.showInputQueueHandle, &in_msg, 0) == pdPASS) {
-      io_printf("Received incoming command: %d, param: %d\n", in_msg.cmd, in_msg.param);
+  // Each state sets how long we may sleep before it needs to run again.
+  // Incoming commands always wake us early.
+  TickType_t pollTicks = portMAX_DELAY;
 
-      switch(in_msg.cmd) {
-        case ShowInputQueueCmd::TriggerLocal:
+  if (RecvShowQueue(in_msg)) {
+    io_printf("Received incoming command: %d, param: %d\n", in_msg.cmd, in_msg.param);
 
-          // Check if its been too soon since the last trigger to prevent
-          // annoying back to back triggering.
-          if (time_since_last_local_trigger >= MIN_LOCAL_TRIGGER_TURNAROUND_MSEC) {
-            time_since_last_local_trigger = 0;
+    switch(in_msg.cmd) {
+      case ShowInputQueueCmd::TriggerLocal:
 
-            START_LOCAL_ANIM();
+        // Check if its been too soon since the last trigger to prevent
+        // annoying back to back triggering.
+        if (time_since_last_local_trigger >= MIN_LOCAL_TRIGGER_TURNAROUND_MSEC) {
+          time_since_last_local_trigger = 0;
 
-            // Send out to peers a remote trigger messsage
-            send_trigger(1);
+          // Send out to peers a remote trigger messsage with a start time
+          // a little in the future, and start ourselves at that same time.
+          // In wave mode peers add their own distance-based delay; the
+          // origin always starts at the base time.
+          scheduledStart = fleet_time_ms() + TRIGGER_START_LEAD_MS;
+          if (scheduledStart == 0) scheduledStart = 1; // 0 means "now"
+          scheduleHorizon = TRIGGER_START_MAX_AHEAD_MS;
+          send_trigger(1, scheduledStart, settingsConfig.waveStepMs());
 
-            showState = SHOWSTATE_START_TABLE;
-          } else {
-            io_printf("Rejecting trigger, too soon!\n");
+          if (profile.playsShow(SHOW_MASK_LOCAL)) {
+            START_LOCAL_ANIM();
+            showState = SHOWSTATE_WAIT_START;
           }
+        } else {
+          io_printf("Rejecting trigger, too soon!\n");
+        }
 
-        break;
+      break;
 
-        case ShowInputQueueCmd::TriggerPeer:
+      case ShowInputQueueCmd::TriggerPeer:
+        if (profile.playsShow(SHOW_MASK_REMOTE)) {
+          // Wave triggers reach us later the further we stand from the
+          // originating station.  Computed locally from the position table.
+          const uint32_t waveDelay = wave_delay_ms(in_msg.origin, in_msg.waveStepMs);
           START_REMOTE_ANIM();
-          showState = SHOWSTATE_START_TABLE;
-        break;
-
-        case ShowInputQueueCmd::Start:
-          START_IDLE_ANIM();
-          showState = SHOWSTATE_START_TABLE;
-          io_printf("Starting show in idle...\n");
-        break;
-
-        case ShowInputQueueCmd::Stop:
-          showState = ShowStates::SHOWSTATE_START_DISABLE;
-          io_printf("Stopping show...\n");
-        break;
-
-        default:
-        // Unsupported command!
-        break;
-      }
+          scheduledStart = in_msg.startAt ? (in_msg.startAt + waveDelay) : 0;
+          if (in_msg.startAt && scheduledStart == 0) scheduledStart = 1;
+          scheduleHorizon = TRIGGER_START_MAX_AHEAD_MS + waveDelay;
+          showState = SHOWSTATE_WAIT_START;
+        }
+      break;
+
+      case ShowInputQueueCmd::Start:
+        START_IDLE_ANIM();
+        showState = SHOWSTATE_START_TABLE;
+        io_printf("Starting show in idle...\n");
+      break;
+
+      case ShowInputQueueCmd::Stop:
+        showState = ShowStates::SHOWSTATE_START_DISABLE;
+        io_printf("Stopping show...\n");
+      break;
+
+      default:
+      // Unsupported command!
+      break;
     }
+  }
 
   //
   // The currentShow and currentShowLength must be selected prior to
@@ -141,6 +222,20 @@ static void ShowTask(void*) {
       // Wait to be reenabled.
     break;
 
+    case SHOWSTATE_WAIT_START:
+    {
+      // Hold the selected show until its fleet start time arrives, sleeping
+      // exactly the remaining time.
+      const int32_t remaining = (int32_t)(scheduledStart - fleet_time_ms());
+      if (scheduledStart == 0 || remaining <= 0 || remaining > (int32_t)scheduleHorizon) {
+        showState = SHOWSTATE_START_TABLE;
+        pollTicks = 0;
+      } else {
+        pollTicks = pdMS_TO_TICKS(remaining);
+      }
+    }
+    break;
+
     case SHOWSTATE_START_TABLE:
       if (!currentShow) {
         START_IDLE_ANIM();
@@ -149,16 +244,24 @@ static void ShowTask(void*) {
       //io_printf("SHOW - START NEW TABLE\n");
       currentStep = 0;
       showState = SHOWSTATE_TABLE_STEP;
+      pollTicks = 0;
     break;
 
     case SHOWSTATE_TABLE_STEP:
       // Activate all animated elements for this step.
       if (currentShow) {
         stepStartTime = millis();
-        SendLightQueue( LightCmdQueueMsg{ LightQueueCmd::Play,  static_cast<uint8_t>(currentShow[currentStep].lightIndex) } );
-        SendAudioQueue( AudioCmdQueueMsg{ AudioQueueCmd::Play,  static_cast<uint8_t>(currentShow[currentStep].audioIndex) } );
-        SendMotorQueue( MotorCmdQueueMsg{ MotorQueueCmd::Play,  static_cast<uint8_t>(currentShow[currentStep].motorIndex) } );
+        // Only feed the subsystems this node's profile started.
+        if (profile.hasLights()) {
+          SendLightQueue( LightCmdQueueMsg{ LightQueueCmd::Play,  static_cast<uint8_t>(currentShow[currentStep].lightIndex), currentShow[currentStep].params } );
+          light_frame_sync();
+        }
+        SendAudioQueue( AudioCmdQueueMsg{ AudioQueueCmd::Play,  static_cast<uint8_t>(currentShow[currentStep].audioIndex), currentShow[currentStep].params } );
+        if (profile.hasMotor()) {
+          SendMotorQueue( MotorCmdQueueMsg{ MotorQueueCmd::Play,  static_cast<uint8_t>(currentShow[currentStep].motorIndex), currentShow[currentStep].params } );
+        }
         showState = SHOWSTATE_STEP_WAIT;
+        pollTicks = 0;
         // io_printf("SHOW - STEP: %d  QUEUED UP LIGHT:%d AUDIO:%d MOTOR:%d\n",
         //   currentStep,
         //   static_cast<uint8_t>(currentShow[currentStep].lightIndex),
@@ -172,7 +275,11 @@ static void ShowTask(void*) {
 
     case SHOWSTATE_STEP_WAIT:
       if (currentShow) {
-        if (millis() - stepStartTime > currentShow[currentStep].duration_ms) {
+        const uint32_t elapsed = millis() - stepStartTime;
+        if (elapsed <= currentShow[currentStep].duration_ms) {
+          // Sleep until the step is over.
+          pollTicks = pdMS_TO_TICKS(currentShow[currentStep].duration_ms - elapsed + 1);
+        } else {
           // Done with this line in the animation steps.
           currentStep++;
           if (currentStep >= currentShowLength) {
@@ -185,6 +292,7 @@ static void ShowTask(void*) {
             showState = SHOWSTATE_TABLE_STEP;
             //io_printf("SHOW - START NEXT STEP num %d of %d\n", currentStep, currentShowLength);
           }
+          pollTicks = 0;
         }
       } else {
         showState = SHOWSTATE_DISABLED;
@@ -193,15 +301,16 @@ static void ShowTask(void*) {
 
   }
 
-  // 
-    vTaskDelay(pdMS_TO_TICKS(10));
+  // Handle any backlog of commands before sleeping.
+  if (queue_depth(BusQueue::ShowInput) > 0) {
+    pollTicks = 0;
   }
+  return pollTicks;
 }
 
+static FrameJob g_showJob = { "show", show_job_init, show_job_step, bus_evt_cmd(BusQueue::ShowInput) };
+
 
-bool show_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core) {
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      ShowTask, "ShowTask", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+bool show_start() {
+  return frame_job_start(g_showJob, TaskId::Show);
 }
\ No newline at end of file
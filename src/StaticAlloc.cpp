@@ -0,0 +1,37 @@
+#include "StaticAlloc.h"
+#include "CommandQueues.h"
+#include "Console.h"
+#include "NetService.h"
+
+// ---- RAM budget ----
+static constexpr size_t STATIC_RAM_BYTES =
+    TASK_RAM_BYTES +
+    QUEUE_BUS_RAM_BYTES +
+    CONSOLE_QUEUE_RAM_BYTES +
+    sizeof(StaticSemaphore_t) +   // io mutex
+    sizeof(NetService);
+
+static_assert(STATIC_RAM_BYTES <= STATIC_RAM_BUDGET_BYTES,
+              "Static task/queue allocation exceeds STATIC_RAM_BUDGET_BYTES");
+
+size_t static_ram_bytes() { return STATIC_RAM_BYTES; }
+
+// ---- Task storage ----
+alignas(STACK_ALIGN) static StackType_t g_stackArena[TASK_STACK_BYTES / sizeof(StackType_t)];
+static StaticTask_t g_tcbs[NUM_TASKS];
+static TaskHandle_t g_handles[NUM_TASKS];
+
+TaskHandle_t static_task_create(TaskId id, TaskFunction_t fn, void* arg)
+{
+  const size_t i = static_cast<size_t>(id);
+  if (i >= NUM_TASKS || g_handles[i] || TASK_TABLE[i].stackBytes == 0)
+  {
+    return nullptr;
+  }
+  const TaskSpec& spec = TASK_TABLE[i];
+  // ESP-IDF stack depth is in bytes (StackType_t is uint8_t).
+  g_handles[i] = xTaskCreateStaticPinnedToCore(
+      fn, spec.name, spec.stackBytes, arg, spec.priority,
+      &g_stackArena[stack_offset(i) / sizeof(StackType_t)], &g_tcbs[i], spec.core);
+  return g_handles[i];
+}
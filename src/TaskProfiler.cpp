@@ -0,0 +1,243 @@
+#include "TaskProfiler.h"
+#include "esp_freertos_hooks.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "IoSync.h"
+
+// ---- Live counters ----
+// Written by the owning task on every wait, read by the sampler.
+struct ProfTask {
+  TaskHandle_t handle;
+  const char*  name;
+  uint32_t     runStartUs;  // When the current burst began (0 = unknown)
+  uint32_t     busyUs;      // Free-running total of burst time
+  uint32_t     wakeups;     // Free-running count of waits returned
+  uint32_t     maxRunUs;    // Longest burst since the last sample
+};
+
+// ---- Sampled history ----
+struct ProfSample {
+  uint32_t busyUs;
+  uint32_t wakeups;
+  uint32_t maxRunUs;
+  uint32_t stackFree;
+};
+
+// Idle task share of one sample period, from the run-time counters.
+struct ProfIdle {
+  uint32_t idleTime;
+  uint32_t totalTime;
+  uint32_t loops;
+};
+
+static portMUX_TYPE g_profMux = portMUX_INITIALIZER_UNLOCKED;
+static ProfTask     g_tasks[PROF_MAX_TASKS];
+static size_t       g_numTasks = 0;
+
+static ProfSample g_hist[PROF_HISTORY][PROF_MAX_TASKS];
+static uint32_t   g_histUs[PROF_HISTORY];     // Sample period length
+static uint32_t   g_lastBusy[PROF_MAX_TASKS];
+static uint32_t   g_lastWake[PROF_MAX_TASKS];
+static uint32_t   g_lastSampleUs = 0;
+static size_t     g_histNext = 0;
+static size_t     g_histCount = 0;
+static size_t     g_numSampled = 0;       // Tasks present in the newest row
+static uint32_t   g_heapFree = 0;
+static uint32_t   g_heapMin = 0;
+
+static ProfIdle          g_idleHist[PROF_HISTORY];
+static volatile uint32_t g_idleLoops[portNUM_PROCESSORS];
+static bool              g_idleHooked = false;
+static uint32_t          g_lastIdleTime = 0;
+static uint32_t          g_lastRunTime = 0;
+static uint32_t          g_lastIdleLoops = 0;
+
+static inline uint32_t now_us() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+// Find the caller's slot, adding it on first use.  nullptr when full.
+static ProfTask* slot_of_current() {
+  const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  const size_t n = g_numTasks;
+  for (size_t i = 0; i < n; i++) {
+    if (g_tasks[i].handle == self) return &g_tasks[i];
+  }
+
+  ProfTask* t = nullptr;
+  portENTER_CRITICAL(&g_profMux);
+  if (g_numTasks < PROF_MAX_TASKS) {
+    t = &g_tasks[g_numTasks];
+    t->handle = self;
+    t->name = pcTaskGetName(self);
+    g_numTasks++;
+  }
+  portEXIT_CRITICAL(&g_profMux);
+  return t;
+}
+
+void prof_wait_begin() {
+  ProfTask* t = slot_of_current();
+  if (!t || t->runStartUs == 0) return;
+
+  const uint32_t run = now_us() - t->runStartUs;
+  portENTER_CRITICAL(&g_profMux);
+  t->busyUs += run;
+  if (run > t->maxRunUs) t->maxRunUs = run;
+  portEXIT_CRITICAL(&g_profMux);
+}
+
+void prof_wait_end() {
+  ProfTask* t = slot_of_current();
+  if (!t) return;
+
+  uint32_t start = now_us();
+  if (start == 0) start = 1;
+  t->runStartUs = start;
+  t->wakeups++;
+}
+
+// ---- Idle ----
+static bool idle_hook() {
+  g_idleLoops[xPortGetCoreID()]++;
+  return true;   // Let the idle task wait for the next interrupt as usual
+}
+
+bool prof_idle_start() {
+  bool ok = true;
+  for (UBaseType_t core = 0; core < portNUM_PROCESSORS; core++) {
+    ok &= esp_register_freertos_idle_hook_for_cpu(idle_hook, core) == ESP_OK;
+  }
+  g_idleHooked = ok;
+  return ok;
+}
+
+static uint32_t idle_loops_total() {
+  uint32_t n = 0;
+  for (size_t core = 0; core < portNUM_PROCESSORS; core++) n += g_idleLoops[core];
+  return n;
+}
+
+// Idle counters since the previous sample.
+static void sample_idle(ProfIdle& out) {
+#if configGENERATE_RUN_TIME_STATS
+  // Both counters are in run-time stat units; only their ratio is used.
+  // On dual core parts this is the idle task of the sampling core.
+  const uint32_t idle = ulTaskGetIdleRunTimeCounter();
+  const uint32_t total = portGET_RUN_TIME_COUNTER_VALUE();
+#else
+  const uint32_t idle = 0;
+  const uint32_t total = 0;
+#endif
+  const uint32_t loops = idle_loops_total();
+  out.idleTime = idle - g_lastIdleTime;
+  out.totalTime = total - g_lastRunTime;
+  out.loops = loops - g_lastIdleLoops;
+  g_lastIdleTime = idle;
+  g_lastRunTime = total;
+  g_lastIdleLoops = loops;
+}
+
+// ---- Sampling ----
+void prof_sample() {
+  const uint32_t now = now_us();
+  const uint32_t periodUs = g_lastSampleUs ? now - g_lastSampleUs : 0;
+  g_lastSampleUs = now;
+
+  ProfSample* row = g_hist[g_histNext];
+  const size_t n = g_numTasks;
+  for (size_t i = 0; i < n; i++) {
+    ProfTask& t = g_tasks[i];
+    portENTER_CRITICAL(&g_profMux);
+    const uint32_t busy = t.busyUs;
+    const uint32_t wake = t.wakeups;
+    const uint32_t maxRun = t.maxRunUs;
+    t.maxRunUs = 0;
+    portEXIT_CRITICAL(&g_profMux);
+
+    row[i].busyUs = busy - g_lastBusy[i];
+    row[i].wakeups = wake - g_lastWake[i];
+    row[i].maxRunUs = maxRun;
+    row[i].stackFree = uxTaskGetStackHighWaterMark(t.handle);
+    g_lastBusy[i] = busy;
+    g_lastWake[i] = wake;
+  }
+  g_numSampled = n;
+  g_heapFree = ESP.getFreeHeap();
+  g_heapMin = ESP.getMinFreeHeap();
+  ProfIdle idle;
+  sample_idle(idle);
+
+  // The first call only sets the baseline.
+  if (periodUs == 0) return;
+  g_idleHist[g_histNext] = idle;
+  g_histUs[g_histNext] = periodUs;
+  g_histNext = (g_histNext + 1) % PROF_HISTORY;
+  if (g_histCount < PROF_HISTORY) g_histCount++;
+}
+
+void prof_print() {
+  io_printf("Heap free: %lu bytes, min ever: %lu bytes\n",
+            (unsigned long)g_heapFree, (unsigned long)g_heapMin);
+  if (g_histCount == 0) {
+    io_printf("No profile samples yet.\n");
+    return;
+  }
+
+  uint64_t totalUs = 0;
+  for (size_t s = 0; s < g_histCount; s++) totalUs += g_histUs[s];
+
+  uint64_t idleTime = 0, runTime = 0, loops = 0;
+  for (size_t s = 0; s < g_histCount; s++) {
+    idleTime += g_idleHist[s].idleTime;
+    runTime += g_idleHist[s].totalTime;
+    loops += g_idleHist[s].loops;
+  }
+  if (runTime) {
+    const uint32_t idleX10 = (uint32_t)(idleTime * 1000 / runTime);
+    io_printf("Idle: %lu.%lu%%", (unsigned long)(idleX10 / 10), (unsigned long)(idleX10 % 10));
+  } else {
+    io_printf("Idle: n/a (no run-time stats)");
+  }
+  if (g_idleHooked) {
+    const uint32_t loopsX10 = (uint32_t)(loops * 10000000ULL / totalUs);
+    io_printf(", idle hook %lu.%lu/s\n", (unsigned long)(loopsX10 / 10), (unsigned long)(loopsX10 % 10));
+  } else {
+    io_printf(", idle hook not registered\n");
+  }
+
+  esp_pm_config_t pm;
+  if (esp_pm_get_configuration(&pm) == ESP_OK) {
+    io_printf("Power management: %d-%d MHz, light sleep %s\n",
+              pm.min_freq_mhz, pm.max_freq_mhz, pm.light_sleep_enable ? "on" : "off");
+  } else {
+    io_printf("Power management: not enabled\n");
+  }
+
+  io_printf("Tasks over last %lu ms:\n", (unsigned long)(totalUs / 1000));
+  io_printf(" %-14s %4s %6s %6s %7s %9s\n", "task", "prio", "stack", "cpu%", "wake/s", "maxrun us");
+
+  const size_t latest = (g_histNext + PROF_HISTORY - 1) % PROF_HISTORY;
+  const size_t n = g_numSampled;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t busy = 0, wake = 0;
+    uint32_t maxRun = 0;
+    for (size_t s = 0; s < g_histCount; s++) {
+      const ProfSample& p = g_hist[s][i];
+      busy += p.busyUs;
+      wake += p.wakeups;
+      if (p.maxRunUs > maxRun) maxRun = p.maxRunUs;
+    }
+    // The high-water mark only ever falls, so the newest sample is the minimum.
+    const uint32_t stackFree = g_hist[latest][i].stackFree;
+    // Tasks that appeared after the oldest sample show a slightly low average.
+    const uint32_t pctX10 = (uint32_t)(busy * 1000 / totalUs);
+    const uint32_t wakeX10 = (uint32_t)(wake * 10000000ULL / totalUs);
+    io_printf(" %-14s %4u %6lu %4lu.%lu %5lu.%lu %9lu\n",
+              g_tasks[i].name, (unsigned)uxTaskPriorityGet(g_tasks[i].handle),
+              (unsigned long)stackFree,
+              (unsigned long)(pctX10 / 10), (unsigned long)(pctX10 % 10),
+              (unsigned long)(wakeX10 / 10), (unsigned long)(wakeX10 % 10),
+              (unsigned long)maxRun);
+  }
+}
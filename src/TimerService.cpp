@@ -0,0 +1,324 @@
+#include "TimerService.h"
+#include "IoSync.h"
+#include "StaticAlloc.h"
+#include "TaskProfiler.h"
+
+// ---- Wheel geometry ----
+static constexpr uint32_t WHEEL_BITS   = 6;
+static constexpr uint32_t WHEEL_SLOTS  = 1u << WHEEL_BITS;   // 64 per level
+static constexpr uint32_t WHEEL_MASK   = WHEEL_SLOTS - 1;
+static constexpr size_t   WHEEL_LEVELS = 3;                  // 1, 64, 4096 ticks
+static constexpr uint32_t WHEEL_SPAN   = 1u << (WHEEL_BITS * WHEEL_LEVELS);
+static constexpr int8_t   NIL = -1;
+
+struct Timer {
+  uint32_t     due;        // Earliest tick it may fire
+  uint32_t     deadline;   // Latest tick it may fire (wheel position)
+  uint32_t     period;     // Ticks between fires, 0 = one-shot
+  uint32_t     slack;      // Ticks
+  TimerFn      fn;         // Callback, or nullptr to notify task
+  void*        arg;
+  TaskHandle_t task;
+  uint32_t     bits;
+  uint32_t     fires;
+  uint32_t     merged;     // Fires that shared another timer's wakeup
+  int8_t       next, prev; // Slot list links
+  int8_t       level;      // NIL when not in the wheel
+  uint8_t      slot;
+  uint8_t      gen;        // Bumped each time the slot is freed
+  bool         used;
+};
+
+static portMUX_TYPE g_timerMux = portMUX_INITIALIZER_UNLOCKED;
+static Timer        g_timers[TIMER_MAX];
+static int8_t       g_wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t     g_occupied[WHEEL_LEVELS];
+static uint32_t     g_tick = 0;            // Next tick to process
+static bool         g_ready = false;
+static TaskHandle_t g_svcTask = nullptr;
+static uint32_t     g_wakeups = 0;
+static uint32_t     g_startTick = 0;
+
+static inline int32_t ticks_until(uint32_t t, uint32_t now) {
+  return (int32_t)(t - now);
+}
+
+// Generations wrap at 128 so a valid id is never negative.
+static inline TimerId make_id(int8_t slot) {
+  return (TimerId)(((g_timers[slot].gen & 0x7F) << 8) | slot);
+}
+
+// Caller holds g_timerMux.
+static void timer_free(int8_t slot) {
+  g_timers[slot].used = false;
+  g_timers[slot].gen++;
+}
+
+// Caller holds g_timerMux.
+static void wheel_init_once() {
+  if (g_ready) return;
+  memset(g_wheel, NIL, sizeof(g_wheel));
+  g_tick = xTaskGetTickCount();
+  g_startTick = g_tick;
+  g_ready = true;
+}
+
+static void wheel_link(int8_t id) {
+  Timer& t = g_timers[id];
+  int32_t delta = ticks_until(t.deadline, g_tick);
+  uint32_t when = t.deadline;
+  if (delta < 0) { delta = 0; when = g_tick; }
+
+  size_t level;
+  uint32_t slot;
+  if ((uint32_t)delta < WHEEL_SLOTS) {
+    level = 0;
+    slot = when & WHEEL_MASK;
+  } else if ((uint32_t)delta < (WHEEL_SLOTS << WHEEL_BITS)) {
+    level = 1;
+    slot = (when >> WHEEL_BITS) & WHEEL_MASK;
+  } else {
+    // Beyond the wheel: park in the furthest level 2 slot and re-cascade.
+    if ((uint32_t)delta >= WHEEL_SPAN) when = g_tick + WHEEL_SPAN - 1;
+    level = 2;
+    slot = (when >> (2 * WHEEL_BITS)) & WHEEL_MASK;
+  }
+
+  t.level = (int8_t)level;
+  t.slot = (uint8_t)slot;
+  t.prev = NIL;
+  t.next = g_wheel[level][slot];
+  if (t.next != NIL) g_timers[t.next].prev = id;
+  g_wheel[level][slot] = id;
+  g_occupied[level] |= (1ULL << slot);
+}
+
+static void wheel_unlink(int8_t id) {
+  Timer& t = g_timers[id];
+  if (t.level == NIL) return;
+  if (t.prev != NIL) g_timers[t.prev].next = t.next;
+  else g_wheel[t.level][t.slot] = t.next;
+  if (t.next != NIL) g_timers[t.next].prev = t.prev;
+  if (g_wheel[t.level][t.slot] == NIL) g_occupied[t.level] &= ~(1ULL << t.slot);
+  t.level = NIL;
+}
+
+// Move every timer in a higher level slot down to where it now belongs.
+static void wheel_cascade(size_t level, uint32_t slot) {
+  int8_t id = g_wheel[level][slot];
+  while (id != NIL) {
+    const int8_t next = g_timers[id].next;
+    wheel_unlink(id);
+    wheel_link(id);
+    id = next;
+  }
+}
+
+// Distance in slots from 'from' to the next occupied slot, or -1.
+static int next_occupied(uint64_t bits, uint32_t from) {
+  if (!bits) return -1;
+  const uint64_t rot = from ? ((bits >> from) | (bits << (WHEEL_SLOTS - from))) : bits;
+  return __builtin_ctzll(rot);
+}
+
+// Tick of the next expiry or cascade, or g_tick + WHEEL_SPAN when empty.
+static uint32_t wheel_next_event() {
+  uint32_t best = g_tick + WHEEL_SPAN;
+  const int d0 = next_occupied(g_occupied[0], g_tick & WHEEL_MASK);
+  if (d0 >= 0) best = g_tick + (uint32_t)d0;
+  for (size_t level = 1; level < WHEEL_LEVELS; level++) {
+    const uint32_t shift = WHEEL_BITS * level;
+    const uint32_t block = g_tick >> shift;
+    const int d = next_occupied(g_occupied[level], (block + 1) & WHEEL_MASK);
+    if (d < 0) continue;
+    const uint32_t at = (block + 1 + (uint32_t)d) << shift;
+    if (ticks_until(at, best) < 0) best = at;
+  }
+  return best;
+}
+
+static void timer_rearm(int8_t id, uint32_t now) {
+  Timer& t = g_timers[id];
+  t.due += t.period;
+  if (ticks_until(t.due, now) <= 0) t.due = now + t.period;  // Fell behind, no burst
+  t.deadline = t.due + t.slack;
+  wheel_link(id);
+}
+
+// Collect everything due up to now.  Caller holds g_timerMux.
+static size_t collect_due(uint32_t now, int8_t* fired) {
+  size_t n = 0;
+  while (ticks_until(g_tick, now) <= 0) {
+    const uint32_t tick = g_tick;
+
+    // Skip straight to the next occupied level 0 slot or cascade boundary
+    // so a long sleep does not walk every tick inside the critical section.
+    if ((tick & WHEEL_MASK) != 0) {
+      const uint32_t boundary = (tick | WHEEL_MASK) + 1;
+      const int d = next_occupied(g_occupied[0], tick & WHEEL_MASK);
+      uint32_t target = (d >= 0 && ticks_until(tick + (uint32_t)d, boundary) < 0) ? tick + (uint32_t)d : boundary;
+      if (ticks_until(target, now) > 0) target = now + 1;
+      if (target != tick) {
+        g_tick = target;
+        continue;
+      }
+    }
+
+    if ((tick & WHEEL_MASK) == 0) {
+      const uint32_t s1 = (tick >> WHEEL_BITS) & WHEEL_MASK;
+      if (s1 == 0) wheel_cascade(2, (tick >> (2 * WHEEL_BITS)) & WHEEL_MASK);
+      wheel_cascade(1, s1);
+    }
+    const uint32_t s0 = tick & WHEEL_MASK;
+    while (g_wheel[0][s0] != NIL) {
+      const int8_t id = g_wheel[0][s0];
+      wheel_unlink(id);
+      if (ticks_until(g_timers[id].deadline, tick) > 0) {
+        wheel_link(id);              // Parked beyond the wheel, not due yet
+        continue;
+      }
+      fired[n++] = id;
+    }
+    g_tick = tick + 1;
+  }
+
+  // Ride along: fire anything already due whose slack would let it wait,
+  // so it shares this wakeup instead of causing its own.
+  if (n > 0) {
+    for (int8_t id = 0; id < (int8_t)TIMER_MAX; id++) {
+      Timer& t = g_timers[id];
+      if (t.used && t.level != NIL && ticks_until(t.due, now) <= 0) {
+        wheel_unlink(id);
+        t.merged++;
+        fired[n++] = id;
+      }
+    }
+  }
+  return n;
+}
+
+static void TimerSvcTask(void*) {
+  int8_t fired[TIMER_MAX];
+  for (;;) {
+    // Run callbacks outside the lock; periodic timers are re-armed first so
+    // a callback may cancel its own timer.
+    portENTER_CRITICAL(&g_timerMux);
+    wheel_init_once();
+    const uint32_t now = xTaskGetTickCount();
+    const size_t n = collect_due(now, fired);
+    TimerFn fns[TIMER_MAX];
+    void* args[TIMER_MAX];
+    TaskHandle_t tasks[TIMER_MAX];
+    uint32_t bits[TIMER_MAX];
+    for (size_t i = 0; i < n; i++) {
+      Timer& t = g_timers[fired[i]];
+      t.fires++;
+      fns[i] = t.fn; args[i] = t.arg; tasks[i] = t.task; bits[i] = t.bits;
+      if (t.period) timer_rearm(fired[i], now);
+      else timer_free(fired[i]);
+    }
+    const int32_t wait = ticks_until(wheel_next_event(), xTaskGetTickCount());
+    portEXIT_CRITICAL(&g_timerMux);
+
+    for (size_t i = 0; i < n; i++) {
+      if (fns[i]) fns[i](args[i]);
+      else if (tasks[i]) xTaskNotify(tasks[i], bits[i], eSetBits);
+    }
+
+    // If a callback took long enough that more is due, go round again.
+    timer_wait(wait > 0 ? (TickType_t)wait : 0);
+    g_wakeups++;
+  }
+}
+
+static TimerId timer_add(uint32_t delayMs, uint32_t periodMs, uint32_t slackMs,
+                         TimerFn fn, void* arg, TaskHandle_t task, uint32_t bits) {
+  int8_t slot = NIL;
+  TimerId id = NIL;
+  portENTER_CRITICAL(&g_timerMux);
+  wheel_init_once();
+  for (int8_t i = 0; i < (int8_t)TIMER_MAX; i++) {
+    if (!g_timers[i].used) { slot = i; break; }
+  }
+  if (slot != NIL) {
+    Timer& t = g_timers[slot];
+    const uint8_t gen = t.gen;
+    t = Timer{};
+    t.gen = gen;
+    t.used = true;
+    t.level = NIL;
+    t.fn = fn;
+    t.arg = arg;
+    t.task = task;
+    t.bits = bits;
+    t.period = pdMS_TO_TICKS(periodMs);
+    t.slack = pdMS_TO_TICKS(slackMs);
+    t.due = xTaskGetTickCount() + pdMS_TO_TICKS(delayMs);
+    t.deadline = t.due + t.slack;
+    wheel_link(slot);
+    id = make_id(slot);
+  }
+  portEXIT_CRITICAL(&g_timerMux);
+
+  // Let the service recompute its sleep.
+  if (id != NIL && g_svcTask && xTaskGetCurrentTaskHandle() != g_svcTask) {
+    xTaskNotify(g_svcTask, 0, eNoAction);
+  }
+  return id;
+}
+
+TimerId timer_every(uint32_t periodMs, uint32_t slackMs, TimerFn fn, void* arg) {
+  if (periodMs == 0 || !fn) return NIL;
+  return timer_add(periodMs, periodMs, slackMs, fn, arg, nullptr, 0);
+}
+
+TimerId timer_once(uint32_t delayMs, uint32_t slackMs, TimerFn fn, void* arg) {
+  if (!fn) return NIL;
+  return timer_add(delayMs, 0, slackMs, fn, arg, nullptr, 0);
+}
+
+TimerId timer_notify_every(uint32_t periodMs, uint32_t slackMs, TaskHandle_t task, uint32_t bits) {
+  if (periodMs == 0 || !task) return NIL;
+  return timer_add(periodMs, periodMs, slackMs, nullptr, nullptr, task, bits);
+}
+
+void timer_cancel(TimerId id) {
+  if (id < 0) return;
+  const int8_t slot = (int8_t)(id & 0xFF);
+  if (slot >= (int8_t)TIMER_MAX) return;
+  portENTER_CRITICAL(&g_timerMux);
+  if (g_timers[slot].used && make_id(slot) == id) {
+    wheel_unlink(slot);
+    timer_free(slot);
+  }
+  portEXIT_CRITICAL(&g_timerMux);
+}
+
+uint32_t timer_wait(TickType_t ticks) {
+  uint32_t bits = 0;
+  prof_wait_begin();
+  xTaskNotifyWait(0, UINT32_MAX, &bits, ticks);
+  prof_wait_end();
+  return bits;
+}
+
+bool timer_service_start() {
+  g_svcTask = static_task_create(TaskId::Timer, TimerSvcTask);
+  return g_svcTask != nullptr;
+}
+
+void timer_print() {
+  const uint32_t upMs = pdTICKS_TO_MS(xTaskGetTickCount() - g_startTick);
+  const uint32_t perSecX10 = upMs ? (uint32_t)((uint64_t)g_wakeups * 10000 / upMs) : 0;
+  io_printf("Timer service: %lu wakeups, %lu.%lu/s\n", (unsigned long)g_wakeups,
+            (unsigned long)(perSecX10 / 10), (unsigned long)(perSecX10 % 10));
+  io_printf(" %-3s %-6s %8s %8s %8s %8s\n", "id", "kind", "period", "slack", "fires", "merged");
+  for (size_t i = 0; i < TIMER_MAX; i++) {
+    const Timer& t = g_timers[i];
+    if (!t.used) continue;
+    io_printf(" %-3u %-6s %8lu %8lu %8lu %8lu\n", (unsigned)i,
+              t.fn ? (t.period ? "call" : "once") : "notify",
+              (unsigned long)pdTICKS_TO_MS(t.period), (unsigned long)pdTICKS_TO_MS(t.slack),
+              (unsigned long)t.fires, (unsigned long)t.merged);
+  }
+}
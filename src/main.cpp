@@ -1,137 +1,274 @@
 #include <Arduino.h>
+#include <new>
 #include "Audio.h"
 #include "CommandQueues.h"
 #include "IoSync.h"
 #include "Console.h"
 #include "CommandExec.h"
-#include "elapsedMillis.h"
+#include "esp_timer.h"
 #include "Faults.h"
+#include "FleetClock.h"
+#include "FrameJob.h"
 #include "Light.h"
 #include "Logging.h"
+#include "main.h"
 #include "Motor.h"
 #include "NetService.h"
+#include "PeerTable.h"
 #include "ota.h"
 #include "Protocol.h"
 #include "ProxDetect.h"
 #include "SettingsStore.h"
 #include "Show.h"
-
-#if defined(ESP32C3_BOARD)
-#define CORE_WORK 0
-#define CORE_WIFI 0
-#elif defined(ESP32C6_BOARD)
-#define CORE_WORK 0
-#define CORE_WIFI 0
-#elif defined(ESP32S3_BOARD)
-#define CORE_WORK 1
-#define CORE_WIFI 1
-
-#endif
+#include "StaticAlloc.h"
+#include "TaskProfiler.h"
+#include "TimerService.h"
 
 static const char *TAG_BOOT = "BOOT";
 
-elapsedMillis time_since_last_ping_msec = 0;
-elapsedMillis time_since_last_blink_msec = 0;
 static const int PING_SEND_PERIOD = 1000;
 static const int CPU_LED_BLINK_PERIOD = 250;
+static const int HOUSEKEEPING_SLACK = 50;   // ms a housekeeping timer may run late
 
 Persist::SettingsStore settingsConfig;
 NetService *networkService = nullptr;
 
-// Network receive callback
-void onPacket(const uint8_t *data, size_t len, const IPAddress &from, void *user)
+// Receive counters by class.  The dispatcher task is the only writer and
+// they only count up; a reset moves the baseline instead, so the console
+// never races the writer.
+static RxClassStats rxTotals;
+static RxClassStats rxBaseline;
+
+static RxClassStats rx_class_totals()
 {
+  RxClassStats t;
+  volatile const RxClassStats &c = rxTotals;
+  t.datagrams = networkService->rxPackets();
+  t.malformed = networkService->rxMalformed();
+  t.duplicates = networkService->rxDuplicates();
+  t.noBuffer = networkService->rxNoBuffer();
+  t.fromSelf = c.fromSelf;
+  t.notForMe = c.notForMe;
+  t.handled = c.handled;
+  t.unknown = c.unknown;
+  for (size_t i = 0; i < Proto::CMD_BATCH; i++)
+  {
+    t.byCmd[i] = c.byCmd[i];
+  }
+  return t;
+}
 
-  Proto::View v;
-  if (!Proto::parse(data, len, v))
+void rx_class_stats_get(RxClassStats &out)
+{
+  const RxClassStats t = rx_class_totals();
+  const RxClassStats &b = rxBaseline;
+  out.datagrams = t.datagrams - b.datagrams;
+  out.malformed = t.malformed - b.malformed;
+  out.duplicates = t.duplicates - b.duplicates;
+  out.noBuffer = t.noBuffer - b.noBuffer;
+  out.fromSelf = t.fromSelf - b.fromSelf;
+  out.notForMe = t.notForMe - b.notForMe;
+  out.handled = t.handled - b.handled;
+  out.unknown = t.unknown - b.unknown;
+  for (size_t i = 0; i < Proto::CMD_BATCH; i++)
   {
-    ESP_LOGI("NET", "[RX] Malformed Mcast packet from 0x%02X",
+    out.byCmd[i] = t.byCmd[i] - b.byCmd[i];
+  }
+}
+
+void rx_class_stats_reset()
+{
+  rxBaseline = rx_class_totals();
+}
+
+// Receive handlers, one per protocol message, on the dispatcher task.  The
+// payload is already decoded; Proto::Dispatcher picks the handler.
+struct RxHandlers
+{
+  static void on(const Proto::PingMsg &m, const Proto::View &v, const NetService::RxPacket &pkt)
+  {
+    ESP_LOGI("NET", "[RX] PING from 0x%02X (%u.%u.%u.%u)",
+             v.hdr.src, pkt.from[0], pkt.from[1], pkt.from[2], pkt.from[3]);
+    peer_table_ping(v.hdr.src, m.rssi, m.rangeMm);
+    if (Proto::has(v, &Proto::PingMsg::fleetMs))
+    {
+      // Track the shared show clock from the sender's fleet time.
+      fleet_clock_observe(v.hdr.src, m.fleetMs, millis());
+    }
+    if (m.queueDrops > 0)
+    {
+      ESP_LOGW("NET", "[RX] Node 0x%02X reports %u queue drops, worst fill %u%%",
+               v.hdr.src, m.queueDrops, m.queueFillPct);
+    }
+  }
+
+  static void on(const Proto::ChangeModeMsg &m, const Proto::View &v, const NetService::RxPacket &)
+  {
+    ESP_LOGI("NET", "[RX] CHANGE_MODE -> %u (from 0x%02X)",
+             m.mode,
              v.hdr.src);
-    return; // bad or too short
+
+    // TODO: signal your control task to apply 'mode'
   }
 
-  ESP_LOGI("NET", "[RX] Mcast Packet from 0x%02X...",
-           v.hdr.src);
+  static void on(const Proto::TriggerAnimMsg &m, const Proto::View &v, const NetService::RxPacket &)
+  {
+    ESP_LOGI("NET", "[RX] TRIGGER_ANIM -> %u at %lu wave %u (from 0x%02X)\n",
+             m.animId, (unsigned long)m.startAtMs, m.waveStepMs, v.hdr.src);
+
+    io_printf("Queued up show trigger %u from station: %d\n", m.animId, v.hdr.src);
+    SendShowQueue(ShowInputQueueMsg{ShowInputQueueCmd::TriggerPeer, m.animId, v.hdr.src, m.waveStepMs, m.startAtMs});
+  }
+
+  static void on(const Proto::TimeReqMsg &m, const Proto::View &v, const NetService::RxPacket &pkt)
+  {
+    // Answer on the next transmit; t3 is stamped by the frame builder.
+    if (fleet_clock_request_rx(v.hdr.src, m.t1, pkt.rxUs))
+    {
+      networkService->post(NetSendQueueMsg{v.hdr.src, Proto::CMD_TIME_RESP});
+    }
+  }
+
+  static void on(const Proto::TimeRespMsg &m, const Proto::View &v, const NetService::RxPacket &pkt)
+  {
+    fleet_clock_exchange(v.hdr.src, m.t1, m.t2, m.t3, pkt.rxUs);
+  }
+};
+typedef Proto::Dispatcher<RxHandlers, const NetService::RxPacket> RxDispatch;
 
+// One command from a received frame, plain or from a batch.
+static void handleCommand(const NetService::RxPacket &pkt, const Proto::View &v)
+{
   if (!Proto::isForMe(settingsConfig.deviceId(), v.hdr.dst))
   {
     ESP_LOGI("NET", "[RX] Mcast Packet not for me.");
+    rxTotals.notForMe++;
     return; // not for me
   }
 
+  if (RxDispatch::dispatch(v, pkt))
+  {
+    rxTotals.handled++;
+    if (v.hdr.cmd < Proto::CMD_BATCH)
+    {
+      rxTotals.byCmd[v.hdr.cmd]++;
+    }
+  }
+  else
+  {
+    rxTotals.unknown++;
+    // Unknown command—safe to ignore for forward compatibility
+    ESP_LOGW("NET", "[RX] %s cmd 0x%02X from 0x%02X, %uB payload\n",
+             RxDispatch::known(v.hdr.cmd) ? "Short" : "Unknown",
+             v.hdr.cmd, v.hdr.src, (unsigned)v.payload_len);
+  }
+}
+
+// Network receive callback, on the dispatcher task.  The packet is already
+// parsed; malformed frames never get here.
+void onPacket(const NetService::RxPacket &pkt, void *user)
+{
+  const Proto::View &v = pkt.view;
+
+  ESP_LOGI("NET", "[RX] Mcast Packet from 0x%02X...",
+           v.hdr.src);
+
   if (v.hdr.src == settingsConfig.deviceId())
   {
     ESP_LOGI("NET", "[RX] Mcast Packet was from self.");
+    rxTotals.fromSelf++;
     return; // Don't process my own messages
   }
 
-  switch (v.hdr.cmd)
+  // Every frame from a peer feeds its link stats, whoever it was for.
+  peer_table_heard(v.hdr, millis());
+
+  // A batch is handled as its commands, one after another.
+  Proto::forEachCommand(v, [&pkt](const Proto::View &cmd) { handleCommand(pkt, cmd); });
+}
+
+// Header and payload for one queued message.
+static size_t buildPayload(const NetSendQueueMsg &m, uint8_t *out, size_t cap)
+{
+  const uint8_t src = settingsConfig.deviceId();
+  switch (m.cmd)
   {
   case Proto::CMD_PING:
-    // No payload; maybe reply or blink an LED
-    ESP_LOGI("NET", "[RX] PING from 0x%02X (%s)",
-             v.hdr.src,
-             from.toString().c_str());
-    break;
+  {
+    Proto::PingMsg ping;
+    ping.rssi = networkService->rssi();
+    ping.rangeMm = (int)prox_range();
+    ping.fleetMs = fleet_time_ms();
+    ping.queueDrops = queue_stats_total_failed();
+    ping.queueFillPct = queue_stats_worst_fill_pct();
+    return Proto::encode(out, cap, m.dest, src, ping);
+  }
 
   case Proto::CMD_CHANGE_MODE:
   {
-    uint8_t mode;
-    if (Proto::decodeChangeMode(v, mode))
-    {
-      ESP_LOGI("NET", "[RX] CHANGE_MODE -> %u (from 0x%02X)",
-               mode,
-               v.hdr.src);
-
-      // TODO: signal your control task to apply 'mode'
-    }
+    Proto::ChangeModeMsg mode;
+    mode.mode = m.param;
+    return Proto::encode(out, cap, m.dest, src, mode);
   }
-  break;
 
   case Proto::CMD_TRIGGER_ANIM:
   {
-    uint8_t animId;
-    if (Proto::decodeTriggerAnim(v, animId))
-    {
-      ESP_LOGI("NET", "[RX] TRIGGER_ANIM -> %u (from 0x%02X)\n", animId, v.hdr.src);
+    Proto::TriggerAnimMsg trig;
+    trig.animId = m.param;
+    trig.startAtMs = m.startAt;
+    trig.waveStepMs = m.waveStepMs;
+    return Proto::encode(out, cap, m.dest, src, trig);
+  }
 
-      io_printf("Queued up show trigger remote station: %d\n", animId);
-      SendShowQueue(ShowInputQueueMsg{ShowInputQueueCmd::TriggerPeer, static_cast<unsigned char>(animId)});
+  case Proto::CMD_TIME_REQ:
+  {
+    Proto::TimeReqMsg req;
+    req.t1 = (uint64_t)esp_timer_get_time();
+    return Proto::encode(out, cap, m.dest, src, req);
+  }
+
+  case Proto::CMD_TIME_RESP:
+  {
+    Proto::TimeRespMsg resp;
+    if (!fleet_clock_response(m.dest, resp.t1, resp.t2))
+    {
+      return 0;
     }
+    resp.t3 = fleet_time_us();
+    return Proto::encode(out, cap, m.dest, src, resp);
   }
-  break;
 
   default:
-    // Unknown command—safe to ignore for forward compatibility
-    ESP_LOGW("NET", "[RX] Unknown cmd 0x%02X from 0x%02X, %uB payload\n",
-             v.hdr.cmd, v.hdr.src, (unsigned)v.payload_len);
-    break;
+    ESP_LOGE("NET", "No frame builder for cmd 0x%02X!", m.cmd);
+    return 0;
   }
 }
 
-// Network ping sender
-bool send_ping()
+// Network join callback, on the net task.  Cache the access point and
+// address for a fast rejoin on the next boot.  The settings are owned by
+// the command executor, which writes them.
+static void onJoined(const NetService::JoinInfo &j, void *user)
 {
-  // Ping packet has one byte for rssi and 2 for range.
-  uint8_t ping_packet[sizeof(Proto::Header) + 3];
-  size_t len = 0;
-
-  // Grab the latest network RSSI to report connectivity status.
-  int8_t rssi = networkService->rssi();
-
-  uint16_t range = (int)prox_range();
+  command_exec_cache_join(j);
+}
 
-  len = Proto::buildPing(ping_packet, sizeof(ping_packet), Proto::BROADCAST,
-                         settingsConfig.deviceId(), rssi, range);
-  if (len == 0)
+// Network transmit frame builder, on the net task just before the frame
+// goes out.  Everything time-sensitive is read here, not when queued.
+size_t buildFrame(const NetSendQueueMsg &m, uint16_t seq, uint8_t *out, size_t cap, void *user)
+{
+  const size_t len = buildPayload(m, out, cap);
+  if (len)
   {
-    ESP_LOGE("NET", "Failed to pack ping message!");
-    return false;
+    Proto::stampHeader(out, seq, fleet_time_ms());
   }
+  return len;
+}
 
+// Network ping sender
+bool send_ping()
+{
   ESP_LOGI("NET", "Sending ping...");
-  int sent = networkService->send(ping_packet, len);
-  if (sent > 0)
+  if (networkService->post(NetSendQueueMsg{Proto::BROADCAST, Proto::CMD_PING}))
   {
     return true;
   }
@@ -140,6 +277,42 @@ bool send_ping()
   return false;
 }
 
+// ---- Housekeeping timers (run on the timer service) ----
+// Pings and clock sync requests share one timer.  A settled clock asks on
+// the ping beat, so the request and the ping are posted together and go
+// out as one batch frame.
+static void net_timer(void*)
+{
+  static uint8_t ticks = 0;
+  const bool ping = (++ticks >= PING_SEND_PERIOD / FLEET_SYNC_FAST_MS);
+  if (ping)
+  {
+    ticks = 0;
+  }
+
+  const uint8_t leader = fleet_clock_sync_target(ping);
+  if (leader != 0xFF)
+  {
+    networkService->post(NetSendQueueMsg{leader, Proto::CMD_TIME_REQ}, ping);
+  }
+  if (ping)
+  {
+    send_ping();
+  }
+}
+
+static void blink_timer(void*)
+{
+#ifdef LED_BUILTIN
+  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+#endif
+}
+
+static void prof_timer(void*)
+{
+  prof_sample();
+}
+
 //
 // On the Xiao ESP32C6 board the antenna source is selectable.
 // Use GPIO3 to enable the selector and GPIO14 to select between
@@ -155,24 +328,9 @@ void esp32c6_use_ext_ant()
   digitalWrite(14, HIGH); // use external antenna
 }
 
-// Determine if this node is capable of detectig proximity events.
-// Return true if it can detect proximity.
-bool is_prox_detect_capable()
-{
-  if ((settingsConfig.deviceId() == 1) ||
-      (settingsConfig.deviceId() == 5) ||
-      (settingsConfig.deviceId() == 6))
-  {
-    return true;
-  }
-  return false;
-}
-
 // Bootup initialization.
 void setup()
 {
-  BaseType_t ok;
-
   Serial.begin(115200);
   delay(2000); // Give serial interface time to startup before using.
 
@@ -192,6 +350,8 @@ void setup()
   // file in the -DCORE_DEBUG_LEVEL=5 definition.
 
   ESP_LOGI(TAG_BOOT, "System startup...\n");
+  ESP_LOGI(TAG_BOOT, "Static task/queue RAM: %u of %u bytes",
+           (unsigned)static_ram_bytes(), (unsigned)STATIC_RAM_BUDGET_BYTES);
 
   // Restore the persistent memory parameters
   if (!settingsConfig.begin())
@@ -205,6 +365,14 @@ void setup()
     ESP_LOGI(TAG_BOOT, "Config restored.");
   }
 
+  // Hardware fitted to this node decides which tasks we start.
+  const NodeProfile profile = settingsConfig.profile();
+  ESP_LOGI(TAG_BOOT, "Node profile: prox=%s motor=%s strip=%s shows=0x%02X",
+           PROX_TYPE_NAMES[static_cast<uint8_t>(profile.proxType)],
+           MOTOR_TYPE_NAMES[static_cast<uint8_t>(profile.motorType)],
+           STRIP_MODEL_NAMES[static_cast<uint8_t>(profile.stripModel)],
+           profile.showMask);
+
   // Perform board specific initialization
 #if defined(ESP32C6_BOARD)
   esp32c6_use_ext_ant();
@@ -215,28 +383,38 @@ void setup()
 
 #endif
 
-  // Create the network services manager
+  // Create the network services manager in static storage.
   // TODO: Use the settingsConfig for multicast IP and Port!!!!!
-  networkService = new NetService(
+  alignas(NetService) static uint8_t netServiceMem[sizeof(NetService)];
+  networkService = new (netServiceMem) NetService(
       settingsConfig.ssid(),
       settingsConfig.password(),
       IPAddress(239, 255, 0, 1), /* Multicast address */
       49400,                     /* Multicast port */
       1);                        /* TTL */
 
-  // Map a callback for network incoming message processing.
+  // Map callbacks for network incoming message processing and outgoing
+  // frame building.
   networkService->onPacket(onPacket);
+  networkService->onTransmit(buildFrame);
 
-  // Start the networking task on Core 0
-  ok = xTaskCreatePinnedToCore(
-      NetService::task,
-      "net",
-      8192, /* Wifi needs larger stack */
-      networkService,
-      5 /*prio*/,
-      nullptr,
-      CORE_WIFI /*core*/);
-  if (ok == pdPASS)
+  // Rejoin the last access point directly, with a static address if set.
+  NetService::JoinInfo hint;
+  if (settingsConfig.wifiJoin(hint.bssid, hint.channel, hint.ip, hint.gw, hint.mask))
+  {
+    networkService->setJoinHint(hint);
+  }
+  uint32_t ip, gw, mask;
+  if (settingsConfig.staticIp(ip, gw, mask))
+  {
+    networkService->setStaticIp(ip, gw, mask,
+                                settingsConfig.ipMode() == Persist::SettingsStore::IpMode::Lease);
+  }
+  networkService->onJoined(onJoined);
+
+  // Start the networking task on the WiFi core, and its dispatcher.
+  if (static_task_create(TaskId::Net, NetService::task, networkService) &&
+      static_task_create(TaskId::NetDispatch, NetService::dispatchTask, networkService))
   {
     ESP_LOGI(TAG_BOOT, "Network task started.");
   }
@@ -246,12 +424,25 @@ void setup()
     ESP_LOGE(TAG_BOOT, "Failed to start network task!");
   }
 
-  // Start the console interface task.
-  if (!console_start(
-          8,    /* Queue Length */
-          2,    /* Priority */
-          4096, /* Stack Bytes */
-          CORE_WORK /* Core */))
+  // Start the timer service that runs the periodic housekeeping.
+  if (!timer_service_start())
+  {
+    FAULT_SET(FAULT_TIMER_SERVICE_FAULT);
+    ESP_LOGE(TAG_BOOT, "Failed to start timer service!");
+  }
+  else
+  {
+    ESP_LOGI(TAG_BOOT, "Timer service started.");
+  }
+
+  // Count idle task passes for the cpu report.
+  if (!prof_idle_start())
+  {
+    ESP_LOGW(TAG_BOOT, "Idle hook not registered.");
+  }
+
+  // Start the console interface.
+  if (!console_start())
   {
     FAULT_SET(FAULT_CONSOLE_TASK_FAULT);
     ESP_LOGE(TAG_BOOT, "Failed to start console task!");
@@ -262,10 +453,7 @@ void setup()
   }
 
   // Start the remote command executor task.
-  if (!command_exec_start(
-          2,    /* Priority */
-          4096, /* Stack Bytes */
-          CORE_WORK /* Core */))
+  if (!command_exec_start())
   {
     FAULT_SET(FAULT_CMD_EXEC_TASK_FAULT);
     ESP_LOGE(TAG_BOOT, "Failed to start command executor task!");
@@ -276,10 +464,7 @@ void setup()
   }
 
   // Start the audio playback task.
-  if (!audio_start(
-          configMAX_PRIORITIES - 1, /* Priority */
-          4096,                     /* Stack Bytes */
-          CORE_WORK /* Core */))
+  if (!audio_start())
   {
     FAULT_SET(FAULT_AUDIO_TASK_FAULT);
     ESP_LOGE(TAG_BOOT, "Failed to start audio task!");
@@ -293,10 +478,11 @@ void setup()
   }
 
   // Start the light animation task.
-  if (!light_start(
-          configMAX_PRIORITIES - 1, /* Priority */
-          4096,                     /* Stack Bytes */
-          CORE_WORK /* Core */))
+  if (!profile.hasLights())
+  {
+    ESP_LOGI(TAG_BOOT, "No light strip fitted, light task not started.");
+  }
+  else if (!light_start(profile.stripModel))
   {
     FAULT_SET(FAULT_LIGHT_TASK_FAULT);
     ESP_LOGE(TAG_BOOT, "Failed to start light task!");
@@ -307,10 +493,11 @@ void setup()
   }
 
   // Start the motor animation task.
-  if (!motor_start(
-          configMAX_PRIORITIES - 1, /* Priority */
-          4096,                     /* Stack Bytes */
-          CORE_WORK /* Core */))
+  if (!profile.hasMotor())
+  {
+    ESP_LOGI(TAG_BOOT, "No motor fitted, motor task not started.");
+  }
+  else if (!motor_start(profile.motorType))
   {
     FAULT_SET(FAULT_MOTOR_TASK_FAULT);
     ESP_LOGE(TAG_BOOT, "Failed to start motor task!");
@@ -320,13 +507,10 @@ void setup()
     ESP_LOGI(TAG_BOOT, "Motor task started.");
   }
 
-  if (is_prox_detect_capable())
+  if (profile.hasProx())
   {
     // Start the proximity detection task.
-    if (!prox_detect_start(
-            configMAX_PRIORITIES - 1, /* Priority */
-            4096,                     /* Stack Bytes */
-            CORE_WORK /* Core */))
+    if (!prox_detect_start(profile.proxType))
     {
       FAULT_SET(FAULT_PROX_DETECT_TASK_FAULT);
       ESP_LOGE(TAG_BOOT, "Failed to start proximity detection task!");
@@ -338,10 +522,7 @@ void setup()
   }
 
     // Start the master show task.
-    if (!show_start(
-            configMAX_PRIORITIES - 1, /* Priority */
-            8192,                     /* Stack Bytes */
-            CORE_WORK /* Core */))
+    if (!show_start())
     {
       FAULT_SET(FAULT_SHOW_TASK_FAULT);
       ESP_LOGE(TAG_BOOT, "Failed to start show task!");
@@ -351,11 +532,22 @@ void setup()
       ESP_LOGI(TAG_BOOT, "Show task started.");
     }
 
+#if defined(USE_FRAME_EXECUTOR)
+    // Light, motor, prox and show were queued as jobs above; run them all
+    // on the one executor task.
+    if (!frame_exec_start())
+    {
+      FAULT_SET(FAULT_SHOW_TASK_FAULT);
+      ESP_LOGE(TAG_BOOT, "Failed to start the frame executor task!");
+    }
+    else
+    {
+      ESP_LOGI(TAG_BOOT, "Frame executor started.");
+    }
+#endif
+
     // Start the Over-The-Air updater task.
-    if (!ota_start(
-            configMAX_PRIORITIES - 1, /* Priority */
-            8192,                     /* Stack Bytes */
-            CORE_WORK /* Core */))
+    if (!ota_start())
     {
       FAULT_SET(FAULT_OTA_TASK_FAULT);
       ESP_LOGE(TAG_BOOT, "Failed to start the OTA task!");
@@ -364,23 +556,21 @@ void setup()
     {
       ESP_LOGI(TAG_BOOT, "OTA task started.");
     }
+
+    // Periodic housekeeping that used to be polled from loop().
+    if (timer_every(FLEET_SYNC_FAST_MS, HOUSEKEEPING_SLACK, net_timer) < 0 ||
+        timer_every(CPU_LED_BLINK_PERIOD, HOUSEKEEPING_SLACK, blink_timer) < 0 ||
+        timer_every(PROF_SAMPLE_MS, HOUSEKEEPING_SLACK, prof_timer) < 0)
+    {
+      ESP_LOGE(TAG_BOOT, "Failed to register housekeeping timers!");
+    }
   }
 
   // Background task
   void loop()
   {
-
-    if (time_since_last_ping_msec >= PING_SEND_PERIOD)
-    {
-      time_since_last_ping_msec = 0;
-      send_ping();
-    }
-
-    if (time_since_last_blink_msec >= CPU_LED_BLINK_PERIOD)
-    {
-      time_since_last_blink_msec = 0;
-#ifdef LED_BUILTIN
-      digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-#endif
-    }
+    // Everything periodic runs on the timer service, so the loop task has
+    // nothing to do.  Delete it rather than let it spin and starve the idle
+    // task; its stack goes back to the heap.
+    vTaskDelete(nullptr);
   }
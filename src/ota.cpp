@@ -1,5 +1,7 @@
 #include <Arduino.h>
 #include "Logging.h"
+#include "StaticAlloc.h"
+#include "TimerService.h"
 #include <WiFi.h>
 #include <ArduinoOTA.h>
 
@@ -36,17 +38,16 @@ static void OTATask(void*) {
   ArduinoOTA.begin();
   ESP_LOGI("OTA", " Ready");
 
-  // Service OTA in a loop
+  // Service OTA at ~50 Hz, woken by the timer service so the poll shares
+  // a wakeup with the console.
+  timer_notify_every(20, 20, xTaskGetCurrentTaskHandle(), 1);
   for (;;) {
     ArduinoOTA.handle();
-    vTaskDelay(pdMS_TO_TICKS(20));  // ~50 Hz is fine
+    timer_wait();
   }
 }
 
 
-bool ota_start(UBaseType_t priority, uint32_t stack_bytes, BaseType_t core) {
-  TaskHandle_t h = nullptr;
-  BaseType_t ok = xTaskCreatePinnedToCore(
-      OTATask, "OTATask", stack_bytes, nullptr, priority, &h, core);
-  return ok == pdPASS;
+bool ota_start() {
+  return static_task_create(TaskId::OTA, OTATask) != nullptr;
 }
\ No newline at end of file